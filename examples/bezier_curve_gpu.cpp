@@ -39,8 +39,8 @@ int main()
     path.outlined = true;
     path.outlineColor = 0xFFFFFFFF;
     path.outlineWidth = 0.002f;
-    //path.primitives.emplace_back(CubicBezier<F32, 2>(Vec2(0, 0), Vec2(0.25, 0.25), Vec2(0.5, 0.25), Vec2(1, 0)));
-    path.primitives.emplace_back
+    //path.primitives.Add(CubicBezier<F32, 2>(Vec2(0, 0), Vec2(0.25, 0.25), Vec2(0.5, 0.25), Vec2(1, 0)));
+    path.primitives.Add
     (
         CubicBezier<F32, 2>
         (
@@ -50,7 +50,7 @@ int main()
             WL::Vec2(0.79261792, 0.83596743)
         )
     );
-    path.primitives.emplace_back(QuadraticBezier<F32, 2>(Vec2(1.0, 0.5), Vec2(0.5, 1.0),Vec2(0.0, 0.5)));
+    path.primitives.Add(QuadraticBezier<F32, 2>(Vec2(1.0, 0.5), Vec2(0.5, 1.0),Vec2(0.0, 0.5)));
     VectorPaths<RT> vectorPaths({ &path, 1u }, 0.6, 0.5, 0.2, 0);
     
     RT::Register(&vectorPaths);
@@ -0,0 +1,65 @@
+// MIT License
+// 
+// Copyright (c) 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <web_lightning.hpp>
+#include <iostream>
+
+
+int main()
+{
+    using namespace WL;
+    using RT = RuntimeGPUText;
+
+    if (!RT::Init())
+    {
+        std::cerr << "Init failed!" << std::endl;
+    }
+
+    LabelDesc desc;
+    desc.text = "Outline text";
+    desc.color = ColorU32(255, 255, 255, 255);
+    desc.offsetX = 0.f;
+    desc.offsetY = 0.f;
+    desc.fontHeight = 0.05f;
+    desc.fontIndex = 0;
+
+    Label<RT> label(desc);
+    label.centered = true;
+    RT::Register(&label);
+
+    // Every height is drawn from the same outlines.
+    RT::AddPreRenderingCode
+    (
+        [&label](F64 dt)
+        {
+            static F32 direction = 1.f;
+            static constexpr F32 heightSpeed = 0.2f / (3.f * 1E6);
+            label.desc.fontHeight += heightSpeed * direction * dt;
+            direction = (label.desc.fontHeight >= 0.2f || label.desc.fontHeight <= 0.02f) ? -direction : direction;
+        }
+    );
+
+    RT::Loop();
+
+    return 0;
+}
@@ -54,6 +54,12 @@ namespace WL
     template <typename TF>
     inline auto Frac(TF n) -> TF;
     template <typename TF>
+    inline auto Floor(TF n) -> TF;
+    template <typename TF>
+    inline auto Ceil(TF n) -> TF;
+    template <typename TF>
+    inline auto Round(TF n) -> TF;
+    template <typename TF>
     inline auto Abs(TF n) -> TF;
 
     template <typename T>
@@ -160,6 +166,27 @@ namespace WL
     }
 
 
+    template <typename TF>
+    inline auto Floor(TF n) -> TF
+    {
+        return std::floor(n);
+    }
+
+
+    template <typename TF>
+    inline auto Ceil(TF n) -> TF
+    {
+        return std::ceil(n);
+    }
+
+
+    template <typename TF>
+    inline auto Round(TF n) -> TF
+    {
+        return std::round(n);
+    }
+
+
     template<typename TF>
     auto Abs(TF n) -> TF
     {
@@ -24,9 +24,18 @@
 #pragma once
 
 #include <common/utilities.hpp>
+#include <common/error.hpp>
 
 #include "algebra.hpp"
 
+#if defined(__wasm_simd128__)
+	#include <wasm_simd128.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+	#include <immintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
 namespace WL
 {
 	template <typename TF, U32 Dim>
@@ -49,7 +58,7 @@ namespace WL
 		};
 
 		QuadraticBezier(const StaticArray<Vec, 3>& pts) : points(pts) {}
-		QuadraticBezier(const Vec& p0, const Vec& p1, const Vec& p2) : p0(p0), p1(p1), p2(p2) {}
+		QuadraticBezier(const Vec& p0 = Vec(), const Vec& p1 = Vec(), const Vec& p2 = Vec()) : p0(p0), p1(p1), p2(p2) {}
 
 		auto GetPolynomialCoefficients() const -> StaticArray<Vec, 3>;
 		auto EvaluateAt(Scalar t) const -> Vec;
@@ -97,6 +106,39 @@ namespace WL
 	template <typename TBezier, typename TF>
 	auto GetSlice(const TBezier& curve, TF t0, TF t1) -> TBezier;
 
+	// Upper bound of quadratics a single cubic is split into, reached only
+	// when the tolerance is far below the size of the curve.
+	static inline constexpr U32 CMaxQuadraticsPerCubic = 64;
+	// Bounds of the cube whose root gives the count, and the bias of the
+	// cube root guess made from the float exponent bits.
+	static inline constexpr F32 CMaxQuadraticsCube = F32(CMaxQuadraticsPerCubic * CMaxQuadraticsPerCubic * CMaxQuadraticsPerCubic);
+	static inline constexpr U32 CCubeRootBias = 0x2A5137A0u;
+
+	// Quadratics needed to stay within tolerance when the cubic is split
+	// uniformly and every piece is replaced by its midpoint quadratic. The
+	// error of that is bounded by sqrt(3) / 36 * |p3 - 3p2 + 3p1 - p0| / n^3.
+	template <typename TF>
+	auto GetQuadraticApproximationCount(const CubicBezier<TF, 2>& cubic, TF tolerance) -> U32;
+	// Batched counts for many cubics, returns their sum. The cube roots
+	// are taken four at a time with SIMD where the target has it.
+	template <typename TF>
+	auto GetQuadraticApproximationCounts(Span<const CubicBezier<TF, 2>> cubics, TF tolerance, Span<U32> counts) -> U32;
+	// Count for a cubic with |p3 - 3p2 + 3p1 - p0|^2 = squaredLength and
+	// scale = sqrt(3) / (36 * tolerance).
+	inline auto GetQuadraticApproximationCount(F32 squaredLength, F32 scale) -> U32;
+	// Counts for the leading blocks of four, SIMD where the target has it
+	// and scalar otherwise. Returns how many lengths it covered.
+	inline auto GetQuadraticApproximationCountBlock(Span<const F32> squaredLengths, F32 scale, U32* counts) -> U32;
+
+	// Writes the approximation into out and returns the number written,
+	// out is expected to have room for GetQuadraticApproximationCount.
+	// Shorter outputs get fewer and less accurate quadratics.
+	template <typename TF>
+	auto ApproximateByQuadratics(const CubicBezier<TF, 2>& cubic, TF tolerance, Span<QuadraticBezier<TF, 2>> out) -> U32;
+	// Batched version with precomputed counts, out receives the
+	// approximations of all cubics back to back.
+	template <typename TF>
+	auto ApproximateByQuadratics(Span<const CubicBezier<TF, 2>> cubics, Span<const U32> counts, Span<QuadraticBezier<TF, 2>> out) -> U32;
 	template <typename TF>
 	auto ApproximateByQuadratics(const CubicBezier<TF, 2>& cubic, TF tolerance = 0.001) -> Array<QuadraticBezier<TF, 2>>;
 }
@@ -265,46 +307,218 @@ namespace WL
 
 
 	template<typename TF>
-	inline auto ApproximateByQuadratics(const CubicBezier<TF, 2>& cubic, TF tolerance) -> Array<QuadraticBezier<TF, 2>>
+	inline auto GetQuadraticApproximationCount(const CubicBezier<TF, 2>& cubic, TF tolerance) -> U32
+	{
+		U32 count;
+		GetQuadraticApproximationCounts<TF>({ &cubic, 1 }, tolerance, { &count, 1 });
+		return count;
+	}
+
+
+	inline auto GetQuadraticApproximationCount(F32 squaredLength, F32 scale) -> U32
 	{
-		Array<QuadraticBezier<TF, 2>> result;
-		Array<CubicBezier<TF, 2>> stack;
-		stack.push_back(cubic);
+		auto cube = Clamp(scale * Sqrt(squaredLength), 1.f, CMaxQuadraticsCube);
+
+		// Cube root from the exponent bits refined by two Newton steps,
+		// std::cbrt has no SIMD counterpart. The rounding is fixed up below.
+		auto root = BitCast<F32>(BitCast<U32>(cube) / 3u + CCubeRootBias);
+		root = (2.f * root + cube / (root * root)) * (1.f / 3.f);
+		root = (2.f * root + cube / (root * root)) * (1.f / 3.f);
+
+		auto n = Ceil(root);
+		n -= F32((n - 1.f) * (n - 1.f) * (n - 1.f) >= cube && n > 1.f);
+		n += F32(n * n * n < cube);
+		return U32(Clamp(n, 1.f, F32(CMaxQuadraticsPerCubic)));
+	}
+
 
-		while (!stack.empty())
+	// Same steps as the scalar count. The exponent bits are divided by three
+	// in float since there is no integer vector division, the guess is a
+	// little different but the fix-up makes the result exact either way.
+	inline auto GetQuadraticApproximationCountBlock(Span<const F32> squaredLengths, F32 scale, U32* counts) -> U32
+	{
+		auto in = squaredLengths.data();
+		auto end = in + squaredLengths.size();
+		auto begin = in;
+
+	#if defined(__wasm_simd128__)
+		auto one = wasm_f32x4_splat(1.f);
+		auto third = wasm_f32x4_splat(1.f / 3.f);
+		while (end - in >= 4)
 		{
-			auto c = stack.back();
-			stack.pop_back();
+			auto cube = wasm_f32x4_mul(wasm_f32x4_sqrt(wasm_v128_load(in)), wasm_f32x4_splat(scale));
+			cube = wasm_f32x4_min(wasm_f32x4_max(cube, one), wasm_f32x4_splat(CMaxQuadraticsCube));
 
-			// Find the tangent intersection.
-			auto t0 = c.p1 - c.p0;
-			auto t1 = c.p3 - c.p2;
-			auto b = c.p3 - c.p0;
+			auto bits = wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_mul(wasm_f32x4_convert_i32x4(cube), third));
+			auto root = wasm_i32x4_add(bits, wasm_i32x4_splat(I32(CCubeRootBias)));
+			for (auto step = 0; step < 2; ++step)
+			{
+				root = wasm_f32x4_mul(wasm_f32x4_add(wasm_f32x4_add(root, root), wasm_f32x4_div(cube, wasm_f32x4_mul(root, root))), third);
+			}
 
-			// We need to solve the equation t0 * x0 - t1 * x1 = b or in matrix form
-			// Mat2x2(t0[0], -t1[0], t0[1], -t1[1]) * Vec2(x0, x1) = b
-			// Use Cramer's rule.
-			auto det = -t0[0] * t1[1] + t1[0] * t0[1];
-			auto x0 = (-b[0] * t1[1] + t1[0] * b[1]) / det;
-			auto intersection = c.p0 + x0 * t0;
+			auto n = wasm_f32x4_ceil(root);
+			auto below = wasm_f32x4_sub(n, one);
+			n = wasm_f32x4_sub(n, wasm_v128_and(wasm_f32x4_ge(wasm_f32x4_mul(wasm_f32x4_mul(below, below), below), cube), one));
+			n = wasm_f32x4_add(n, wasm_v128_and(wasm_f32x4_lt(wasm_f32x4_mul(wasm_f32x4_mul(n, n), n), cube), one));
+			n = wasm_f32x4_min(wasm_f32x4_max(n, one), wasm_f32x4_splat(F32(CMaxQuadraticsPerCubic)));
+			wasm_v128_store(counts, wasm_u32x4_trunc_sat_f32x4(n));
+			in += 4;
+			counts += 4;
+		}
+	#elif defined(__AVX2__) || defined(__SSE4_1__)
+		auto one = _mm_set1_ps(1.f);
+		auto third = _mm_set1_ps(1.f / 3.f);
+		while (end - in >= 4)
+		{
+			auto cube = _mm_mul_ps(_mm_sqrt_ps(_mm_loadu_ps(in)), _mm_set1_ps(scale));
+			cube = _mm_min_ps(_mm_max_ps(cube, one), _mm_set1_ps(CMaxQuadraticsCube));
 
-			QuadraticBezier<TF, 2> approx(c.p0, intersection, c.p3);
+			auto bits = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_castps_si128(cube)), third));
+			auto root = _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(I32(CCubeRootBias))));
+			for (auto step = 0; step < 2; ++step)
+			{
+				root = _mm_mul_ps(_mm_add_ps(_mm_add_ps(root, root), _mm_div_ps(cube, _mm_mul_ps(root, root))), third);
+			}
 
-			auto halfValueCubic = c.EvaluateAt(TF(0.5));
-			auto halfValueQuadratic = approx.EvaluateAt(TF(0.5));
+			auto n = _mm_ceil_ps(root);
+			auto below = _mm_sub_ps(n, one);
+			n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpge_ps(_mm_mul_ps(_mm_mul_ps(below, below), below), cube), one));
+			n = _mm_add_ps(n, _mm_and_ps(_mm_cmplt_ps(_mm_mul_ps(_mm_mul_ps(n, n), n), cube), one));
+			n = _mm_min_ps(_mm_max_ps(n, one), _mm_set1_ps(F32(CMaxQuadraticsPerCubic)));
+			_mm_storeu_si128((__m128i*)counts, _mm_cvttps_epi32(n));
+			in += 4;
+			counts += 4;
+		}
+	#elif defined(__ARM_NEON)
+		auto one = vdupq_n_f32(1.f);
+		auto third = vdupq_n_f32(1.f / 3.f);
+		auto oneBits = vreinterpretq_u32_f32(one);
+		while (end - in >= 4)
+		{
+			auto cube = vmulq_n_f32(vsqrtq_f32(vld1q_f32(in)), scale);
+			cube = vminq_f32(vmaxq_f32(cube, one), vdupq_n_f32(CMaxQuadraticsCube));
 
-			if ((halfValueCubic - halfValueQuadratic).Length() < tolerance)
+			auto bits = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_f32(cube)), third));
+			auto root = vreinterpretq_f32_s32(vaddq_s32(bits, vdupq_n_s32(I32(CCubeRootBias))));
+			for (auto step = 0; step < 2; ++step)
 			{
-				result.push_back(approx);
+				root = vmulq_f32(vaddq_f32(vaddq_f32(root, root), vdivq_f32(cube, vmulq_f32(root, root))), third);
 			}
-			else
+
+			auto n = vrndpq_f32(root);
+			auto below = vsubq_f32(n, one);
+			n = vsubq_f32(n, vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(vmulq_f32(vmulq_f32(below, below), below), cube), oneBits)));
+			n = vaddq_f32(n, vreinterpretq_f32_u32(vandq_u32(vcltq_f32(vmulq_f32(vmulq_f32(n, n), n), cube), oneBits)));
+			n = vminq_f32(vmaxq_f32(n, one), vdupq_n_f32(F32(CMaxQuadraticsPerCubic)));
+			vst1q_u32(counts, vcvtq_u32_f32(n));
+			in += 4;
+			counts += 4;
+		}
+	#else
+		while (in < end)
+		{
+			*counts++ = GetQuadraticApproximationCount(*in++, scale);
+		}
+	#endif
+
+		return in - begin;
+	}
+
+
+	template<typename TF>
+	inline auto GetQuadraticApproximationCounts(Span<const CubicBezier<TF, 2>> cubics, TF tolerance, Span<U32> counts) -> U32
+	{
+		WL_ASSERT(counts.size() >= cubics.size());
+
+		constexpr U32 CChunkSize = 64;
+
+		auto scale = F32(Sqrt(TF(3)) / (TF(36) * tolerance));
+		auto total = 0u;
+		StaticArray<F32, CChunkSize> squaredLengths;
+		for (auto first = 0u; first < cubics.size(); first += CChunkSize)
+		{
+			auto size = Min(U32(cubics.size()) - first, CChunkSize);
+			for (auto i = 0u; i < size; ++i)
+			{
+				auto& c = cubics[first + i];
+				auto dx = F32(c.p3[0] - TF(3) * c.p2[0] + TF(3) * c.p1[0] - c.p0[0]);
+				auto dy = F32(c.p3[1] - TF(3) * c.p2[1] + TF(3) * c.p1[1] - c.p0[1]);
+				squaredLengths[i] = dx * dx + dy * dy;
+			}
+
+			auto covered = GetQuadraticApproximationCountBlock({ squaredLengths.data(), size }, scale, &counts[first]);
+			for (auto i = covered; i < size; ++i)
+			{
+				counts[first + i] = GetQuadraticApproximationCount(squaredLengths[i], scale);
+			}
+
+			for (auto i = 0u; i < size; ++i)
 			{
-				auto split = c.Split(TF(0.5));
-				stack.push_back(split.second);
-				stack.push_back(split.first);
+				total += counts[first + i];
 			}
 		}
 
+		return total;
+	}
+
+
+	template<typename TF>
+	inline auto ApproximateByQuadratics(const CubicBezier<TF, 2>& cubic, TF tolerance, Span<QuadraticBezier<TF, 2>> out) -> U32
+	{
+		auto count = Min(GetQuadraticApproximationCount(cubic, tolerance), U32(out.size()));
+		return ApproximateByQuadratics<TF>({ &cubic, 1 }, { &count, 1 }, out);
+	}
+
+
+	template<typename TF>
+	inline auto ApproximateByQuadratics(Span<const CubicBezier<TF, 2>> cubics, Span<const U32> counts, Span<QuadraticBezier<TF, 2>> out) -> U32
+	{
+		using Vec = CubicBezier<TF, 2>::Vec;
+
+		auto written = 0u;
+		for (auto i = 0u; i < cubics.size(); ++i)
+		{
+			auto& c = cubics[i];
+			auto n = counts[i];
+			WL_ASSERT(n && written + n <= out.size());
+
+			// Power basis of the curve and its derivative.
+			auto a = c.p3 - TF(3) * c.p2 + TF(3) * c.p1 - c.p0;
+			auto b = TF(3) * (c.p2 - TF(2) * c.p1 + c.p0);
+			auto d = TF(3) * (c.p1 - c.p0);
+			auto evaluate = [&](TF t) { return ((a * t + b) * t + d) * t + c.p0; };
+			auto derivative = [&](TF t) { return (TF(3) * a * t + TF(2) * b) * t + d; };
+
+			// The piece over [t0, t1] has the control points p(t0),
+			// p(t0) + h / 3 * p'(t0), p(t1) - h / 3 * p'(t1) and p(t1),
+			// its midpoint quadratic has (3 (c1 + c2) - c0 - c3) / 4 as
+			// control point.
+			auto h = TF(1) / TF(n);
+			Vec start = c.p0;
+			Vec startDerivative = d;
+			for (auto k = 1u; k <= n; ++k)
+			{
+				auto t = TF(k) * h;
+				Vec end = k == n? c.p3 : evaluate(t);
+				Vec endDerivative = derivative(t);
+				Vec control = (start + end) * TF(0.5) + (startDerivative - endDerivative) * (h * TF(0.25));
+
+				out[written++] = QuadraticBezier<TF, 2>(start, control, end);
+				start = end;
+				startDerivative = endDerivative;
+			}
+		}
+
+		return written;
+	}
+
+
+	template<typename TF>
+	inline auto ApproximateByQuadratics(const CubicBezier<TF, 2>& cubic, TF tolerance) -> Array<QuadraticBezier<TF, 2>>
+	{
+		auto count = GetQuadraticApproximationCount(cubic, tolerance);
+		Array<QuadraticBezier<TF, 2>> result(count);
+		ApproximateByQuadratics<TF>({ &cubic, 1 }, { &count, 1 }, result);
 		return result;
 	}
-}
\ No newline at end of file
+}
@@ -79,27 +79,17 @@ namespace WL
 		pathPtr = &path;
 	#endif
 
-		for (auto& prim : path.primitives)
-		{
-			Visit<V>
-			(
-				[&](const auto& prim) -> V
-				{
-					reparametrizations.emplace_back(prim);
-				},
-				prim
-			);
-			
-			Visit<V>
-			(
-				[&](const auto& prim) -> V
-				{
-					cumulativeLength.push_back(prim.GetMaxArcLength());
-				},
-				reparametrizations.back()
-			);
-			
-		}
+		reparametrizations.reserve(path.primitives.GetSize());
+		cumulativeLength.reserve(path.primitives.GetSize());
+		path.primitives.ForEach
+		(
+			[&](const auto& prim) -> V
+			{
+				ArcLengthReparametrization<std::remove_cvref_t<decltype(prim)>> reparametrization(prim);
+				cumulativeLength.push_back(reparametrization.GetMaxArcLength());
+				reparametrizations.emplace_back(std::move(reparametrization));
+			}
+		);
 
 		for (auto i = 1; i < cumulativeLength.size(); ++i)
 		{
@@ -214,13 +204,13 @@ namespace WL
 		auto sum = Scalar(0);
 		for (auto i = 0; i < currentState.size(); ++i)
 		{
-			Visit<V>
+			pathPtr->primitives.Visit
 			(
+				currentState[i].curveIdx,
 				[&](const auto& prim) -> V
 				{
 					sum += GetArcLength(prim, currentState[i].t0, currentState[i].t1);
-				},
-				pathPtr->primitives[currentState[i].curveIdx]
+				}
 			);
 		}
 		WL_ASSERT(particleLength > sum || Abs(sum - particleLength) < Scalar(0.01 * particleLength));
@@ -39,6 +39,10 @@ namespace WL
     template <typename T>
     concept CIsArithmetic = std::floating_point<T> || std::integral<T>;
 
+    // Ignores references and qualifiers, for dispatching in generic visitors.
+    template <typename T, typename U>
+    concept CIsSame = std::same_as<std::remove_cvref_t<T>, std::remove_cvref_t<U>>;
+
     template <typename T, typename U>
     struct SizeAtLeast : std::integral_constant<bool, sizeof(T) >= sizeof(U)> {};
 
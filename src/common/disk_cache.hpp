@@ -0,0 +1,231 @@
+// MIT License
+// 
+// Copyright (c) 2023 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <lizard/xxhash/xxhash.h>
+
+#include <decoders/lizard.hpp>
+
+#include "types.hpp"
+#include "logging.hpp"
+#include "utilities.hpp"
+
+#if __EMSCRIPTEN__
+	#include <emscripten/emscripten.h>
+#endif
+
+namespace WL
+{
+	// Content addressed store for expensive to rebuild data like font atlases
+	// and SVG rasters. Keys are XXH64 hashes of everything an entry depends
+	// on, entries are Lizard compressed files. On the web the directory is an
+	// IDBFS mount which index.html populates before main runs, Flush writes
+	// new entries back to IndexedDB.
+	class DiskCache
+	{
+	public:
+		static constexpr const C* CDefaultDirectory = "wl_cache";
+		// Bump when the layout of any cached entry changes.
+		static constexpr U32 CVersion = 2;
+
+		inline static auto Init(StrView directory = CDefaultDirectory) -> B;
+		inline static auto IsEnabled() -> B;
+
+		inline static auto Hash(Span<const Byte> data, U64 seed = 0) -> U64;
+		template <typename T>
+		inline static auto HashValue(const T& value, U64 seed = 0) -> U64;
+
+		// Returns the decompressed entry, empty if it's missing or corrupted.
+		inline static auto Load(U64 key) -> Array<Byte>;
+		// Safe to call from worker threads.
+		inline static auto Store(U64 key, Span<const Byte> data) -> B;
+		inline static auto Flush() -> V;
+
+	private:
+		static constexpr U32 CMagic = 0x43444C57;
+
+		struct EntryHeader
+		{
+			U32 magic;
+			U32 version;
+			U64 key;
+		};
+
+		inline static auto GetEntryPath(U64 key) -> std::filesystem::path;
+
+		inline static std::filesystem::path directory;
+		inline static B enabled = false;
+		inline static std::atomic<B> dirty = false;
+	};
+}
+
+
+namespace WL
+{
+	inline auto DiskCache::Init(StrView dir) -> B
+	{
+		directory = std::filesystem::path(dir);
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		enabled = !error;
+
+		if (error)
+		{
+			LogError("Disk cache disabled, can't create ", directory.string(), ": ", error.message());
+		}
+
+		return enabled;
+	}
+
+
+	inline auto DiskCache::IsEnabled() -> B
+	{
+		return enabled;
+	}
+
+
+	inline auto DiskCache::Hash(Span<const Byte> data, U64 seed) -> U64
+	{
+		return XXH64(data.data(), data.size(), seed);
+	}
+
+
+	template <typename T>
+	inline auto DiskCache::HashValue(const T& value, U64 seed) -> U64
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return XXH64(&value, sizeof(T), seed);
+	}
+
+
+	inline auto DiskCache::Load(U64 key) -> Array<Byte>
+	{
+		Array<Byte> result;
+		if (!enabled)
+		{
+			return result;
+		}
+
+		std::ifstream file(GetEntryPath(key), std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return result;
+		}
+
+		Array<Byte> contents(file.tellg());
+		file.seekg(0);
+		file.read((C*)contents.data(), contents.size());
+
+		Span<const Byte> in(contents);
+		EntryHeader header;
+		if (!file || !ReadBytes(in, header) || header.magic != CMagic || header.version != CVersion || header.key != key || in.size() < 4)
+		{
+			return result;
+		}
+
+		return DecompressLizard(in);
+	}
+
+
+	inline auto DiskCache::Store(U64 key, Span<const Byte> data) -> B
+	{
+		if (!enabled)
+		{
+			return false;
+		}
+
+		auto compressed = CompressLizard(data);
+		if (compressed.empty())
+		{
+			return false;
+		}
+
+		Array<Byte> contents;
+		contents.reserve(sizeof(EntryHeader) + compressed.size());
+		WriteBytes(contents, EntryHeader{ CMagic, CVersion, key });
+		WriteBytes(contents, Span<const Byte>(compressed));
+
+		// Written aside and renamed so a crash never leaves a truncated entry.
+		auto path = GetEntryPath(key);
+		auto tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			file.write((const C*)contents.data(), contents.size());
+			if (!file)
+			{
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+		{
+			return false;
+		}
+
+		dirty = true;
+		return true;
+	}
+
+
+	inline auto DiskCache::Flush() -> V
+	{
+		if (!dirty.exchange(false))
+		{
+			return;
+		}
+
+	#if __EMSCRIPTEN__
+		auto started = EM_ASM_INT(
+			if (Module.wlCacheSyncing)
+			{
+				return 0;
+			}
+			Module.wlCacheSyncing = true;
+			FS.syncfs(false, function(error) { Module.wlCacheSyncing = false; });
+			return 1;
+		);
+
+		// Retry on a later call if a sync is still running.
+		if (!started)
+		{
+			dirty = true;
+		}
+	#endif
+	}
+
+
+	inline auto DiskCache::GetEntryPath(U64 key) -> std::filesystem::path
+	{
+		C name[24];
+		snprintf(name, sizeof(name), "%016llx.lz", (unsigned long long)key);
+		return directory / name;
+	}
+}
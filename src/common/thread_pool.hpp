@@ -0,0 +1,240 @@
+// MIT License
+// 
+// Copyright (c) 2023 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include "types.hpp"
+#include "error.hpp"
+
+#ifdef WL_USE_THREADS
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+	#include <latch>
+#endif
+
+namespace WL
+{
+	// Fixed pool of worker threads. Without WL_USE_THREADS (Emscripten builds
+	// served without cross-origin isolation have no SharedArrayBuffer) jobs
+	// run inline on the calling thread.
+	class ThreadPool
+	{
+	public:
+		inline ThreadPool(U32 threadCount = DefaultThreadCount());
+		inline ~ThreadPool();
+
+		inline auto Submit(Function<V()> job) -> V;
+		// Queues a long job for the workers only. ParallelFor callers don't
+		// help with these, so they never stall a frame. Workers pick them
+		// after the regular jobs. Expects GetThreadCount() > 0.
+		inline auto SubmitBackground(Function<V()> job) -> V;
+		// Runs body(i) for every i in [0, count) and returns when all are
+		// done. The calling thread works on the queue while waiting.
+		template <typename TFunc>
+		inline auto ParallelFor(U32 count, const TFunc& body) -> V;
+
+		inline auto GetThreadCount() const -> U32;
+		// Hardware threads minus the calling one, which helps in ParallelFor.
+		inline static auto DefaultThreadCount() -> U32;
+
+	private:
+	#ifdef WL_USE_THREADS
+		inline auto TryRunJob() -> B;
+		inline auto WorkerLoop() -> V;
+
+		Array<std::thread> threads;
+		Deque<Function<V()>> jobs;
+		Deque<Function<V()>> backgroundJobs;
+		std::mutex jobsMutex;
+		std::condition_variable jobAvailable;
+		B stopping = false;
+	#endif
+	};
+
+	inline auto GetThreadPool() -> ThreadPool&;
+}
+
+
+namespace WL
+{
+	inline ThreadPool::ThreadPool(U32 threadCount)
+	{
+	#ifdef WL_USE_THREADS
+		threads.reserve(threadCount);
+		for (auto i = 0u; i < threadCount; ++i)
+		{
+			threads.emplace_back([this]() { WorkerLoop(); });
+		}
+	#endif
+	}
+
+
+	inline ThreadPool::~ThreadPool()
+	{
+	#ifdef WL_USE_THREADS
+		{
+			std::lock_guard lock(jobsMutex);
+			stopping = true;
+		}
+		jobAvailable.notify_all();
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	#endif
+	}
+
+
+	inline auto ThreadPool::Submit(Function<V()> job) -> V
+	{
+	#ifdef WL_USE_THREADS
+		if (threads.empty())
+		{
+			job();
+			return;
+		}
+
+		{
+			std::lock_guard lock(jobsMutex);
+			jobs.push_back(std::move(job));
+		}
+		jobAvailable.notify_one();
+	#else
+		job();
+	#endif
+	}
+
+
+	inline auto ThreadPool::SubmitBackground(Function<V()> job) -> V
+	{
+	#ifdef WL_USE_THREADS
+		WL_ASSERT(!threads.empty());
+
+		{
+			std::lock_guard lock(jobsMutex);
+			backgroundJobs.push_back(std::move(job));
+		}
+		jobAvailable.notify_one();
+	#else
+		WL_ASSERT(false);
+	#endif
+	}
+
+
+	template <typename TFunc>
+	inline auto ThreadPool::ParallelFor(U32 count, const TFunc& body) -> V
+	{
+	#ifdef WL_USE_THREADS
+		std::latch done(count);
+		for (auto i = 0u; i < count; ++i)
+		{
+			Submit([&body, &done, i]() { body(i); done.count_down(); });
+		}
+
+		while (!done.try_wait())
+		{
+			if (!TryRunJob())
+			{
+				done.wait();
+			}
+		}
+	#else
+		for (auto i = 0u; i < count; ++i)
+		{
+			body(i);
+		}
+	#endif
+	}
+
+
+	inline auto ThreadPool::GetThreadCount() const -> U32
+	{
+	#ifdef WL_USE_THREADS
+		return threads.size();
+	#else
+		return 0;
+	#endif
+	}
+
+
+	inline auto ThreadPool::DefaultThreadCount() -> U32
+	{
+	#ifdef WL_USE_THREADS
+		auto hardwareThreads = std::thread::hardware_concurrency();
+		return hardwareThreads > 1? hardwareThreads - 1 : 0;
+	#else
+		return 0;
+	#endif
+	}
+
+
+#ifdef WL_USE_THREADS
+	inline auto ThreadPool::TryRunJob() -> B
+	{
+		Function<V()> job;
+		{
+			std::lock_guard lock(jobsMutex);
+			if (jobs.empty())
+			{
+				return false;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+		return true;
+	}
+
+
+	inline auto ThreadPool::WorkerLoop() -> V
+	{
+		while (true)
+		{
+			Function<V()> job;
+			{
+				std::unique_lock lock(jobsMutex);
+				jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty() || !backgroundJobs.empty(); });
+
+				if (stopping && jobs.empty() && backgroundJobs.empty())
+				{
+					return;
+				}
+
+				auto& queue = jobs.empty()? backgroundJobs : jobs;
+				job = std::move(queue.front());
+				queue.pop_front();
+			}
+
+			job();
+		}
+	}
+#endif
+
+
+	inline auto GetThreadPool() -> ThreadPool&
+	{
+		static ThreadPool threadPool;
+		return threadPool;
+	}
+}
@@ -36,6 +36,7 @@
 #include <string_view>
 
 #include <functional>
+#include <memory>
 
 #include <any>
 #include <variant>
@@ -103,6 +104,16 @@ namespace WL
     using Function = std::function<T>;
 
 
+    template <typename T>
+    using SharedPtr = std::shared_ptr<T>;
+
+    template <typename T, typename... TArgs>
+    auto MakeShared(TArgs&&... args) -> SharedPtr<T>
+    {
+        return std::make_shared<T>(std::forward<TArgs>(args)...);
+    }
+
+
     using Any = std::any;
 
     template <typename T>
@@ -23,7 +23,18 @@
 
 #pragma once
 
+#include <cstring>
+
 #include "types.hpp"
+#include "error.hpp"
+
+#if defined(__wasm_simd128__)
+	#include <wasm_simd128.h>
+#elif defined(__AVX2__) || defined(__SSE4_1__)
+	#include <immintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
 
 namespace WL
 {
@@ -36,58 +47,194 @@ namespace WL
 	};
 
 	inline static constexpr UnicodeRange CBasicLatin = { 0x0020, 0x007F };
+	inline static constexpr I32 CReplacementCharacter = 0xFFFD;
 
+	// Decodes into out, which needs room for in.size() codepoints, and
+	// returns how many were written. Malformed sequences decode to
+	// CReplacementCharacter, one per maximal invalid subpart.
+	inline auto DecodeUTF8(Span<const Byte> in, Span<I32> out) -> U32;
 	inline auto DecodeUTF8(Span<const Byte> in) -> Array<I32>;
 }
 
 
 namespace WL
 {
-	inline auto DecodeUTF8(Span<const Byte> in) -> Array<I32>
+	// Widens the ASCII prefix of a block, returns how many bytes it covered.
+	inline auto DecodeASCIIBlock(const Byte* in, const Byte* end, I32* out) -> U32
 	{
-		Array<I32> codepoints;
-		for (auto i = 0; i < in.size(); ++i)
+		auto begin = in;
+
+	#if defined(__wasm_simd128__)
+		while (end - in >= 16)
 		{
-			auto byte = in[i];
+			auto bytes = wasm_v128_load(in);
+			if (wasm_i8x16_bitmask(bytes))
+			{
+				break;
+			}
 
-			if ((byte & 0b10000000) == 0)
+			auto low = wasm_u16x8_extend_low_u8x16(bytes);
+			auto high = wasm_u16x8_extend_high_u8x16(bytes);
+			wasm_v128_store(out, wasm_u32x4_extend_low_u16x8(low));
+			wasm_v128_store(out + 4, wasm_u32x4_extend_high_u16x8(low));
+			wasm_v128_store(out + 8, wasm_u32x4_extend_low_u16x8(high));
+			wasm_v128_store(out + 12, wasm_u32x4_extend_high_u16x8(high));
+			in += 16;
+			out += 16;
+		}
+	#elif defined(__AVX2__)
+		while (end - in >= 16)
+		{
+			auto bytes = _mm_loadu_si128((const __m128i*)in);
+			if (_mm_movemask_epi8(bytes))
 			{
-				codepoints.push_back(byte);
+				break;
 			}
-			else if ((byte & 0b11100000u) == 0b11000000)
+
+			_mm256_storeu_si256((__m256i*)out, _mm256_cvtepu8_epi32(bytes));
+			_mm256_storeu_si256((__m256i*)(out + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+			in += 16;
+			out += 16;
+		}
+	#elif defined(__SSE4_1__)
+		while (end - in >= 16)
+		{
+			auto bytes = _mm_loadu_si128((const __m128i*)in);
+			if (_mm_movemask_epi8(bytes))
 			{
-				i++;
-				if (i < in.size())
-				{
-					auto c0 = I32(in[i] & 0b00111111);
-					auto c1 = I32(byte & 0b00011111) << 6;
-					codepoints.push_back(c0 | c1);
-				}
+				break;
 			}
-			else if ((byte & 0b11110000u) == 0b11100000)
+
+			_mm_storeu_si128((__m128i*)out, _mm_cvtepu8_epi32(bytes));
+			_mm_storeu_si128((__m128i*)(out + 4), _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)));
+			_mm_storeu_si128((__m128i*)(out + 8), _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+			_mm_storeu_si128((__m128i*)(out + 12), _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)));
+			in += 16;
+			out += 16;
+		}
+	#elif defined(__ARM_NEON)
+		while (end - in >= 16)
+		{
+			auto bytes = vld1q_u8(in);
+			if (vmaxvq_u8(bytes) >= 0x80)
+			{
+				break;
+			}
+
+			auto low = vmovl_u8(vget_low_u8(bytes));
+			auto high = vmovl_u8(vget_high_u8(bytes));
+			vst1q_s32(out, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+			vst1q_s32(out + 4, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+			vst1q_s32(out + 8, vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(high))));
+			vst1q_s32(out + 12, vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(high))));
+			in += 16;
+			out += 16;
+		}
+	#else
+		while (end - in >= 8)
+		{
+			U64 word;
+			memcpy(&word, in, sizeof(word));
+			if (word & 0x8080808080808080ull)
+			{
+				break;
+			}
+
+			for (auto i = 0; i < 8; ++i)
+			{
+				out[i] = in[i];
+			}
+			in += 8;
+			out += 8;
+		}
+	#endif
+
+		return in - begin;
+	}
+
+
+	inline auto DecodeUTF8(Span<const Byte> in, Span<I32> out) -> U32
+	{
+		WL_ASSERT(out.size() >= in.size());
+
+		auto src = in.data();
+		auto end = src + in.size();
+		auto dst = out.data();
+
+		while (src < end)
+		{
+			if (*src < 0x80)
 			{
-				i += 2;
-				if (i < in.size())
+				auto count = DecodeASCIIBlock(src, end, dst);
+				if (!count)
 				{
-					auto c0 = I32(in[i] & 0b00111111);
-					auto c1 = I32(in[i - 1] & 0b00111111) << 6;
-					auto c2 = I32(byte & 0b00001111) << 12;
-					codepoints.push_back(c0 | c1 | c2);
+					*dst++ = *src++;
 				}
+				src += count;
+				dst += count;
+				continue;
+			}
+
+			// Length and the range of the second byte for each lead byte, the
+			// narrower ranges reject overlong forms, surrogates and values
+			// past U+10FFFF.
+			auto lead = *src;
+			U32 length = 0;
+			Byte secondMin = 0x80;
+			Byte secondMax = 0xBF;
+			I32 codepoint = 0;
+
+			if (lead >= 0xC2 && lead <= 0xDF)
+			{
+				length = 2;
+				codepoint = lead & 0x1F;
+			}
+			else if (lead >= 0xE0 && lead <= 0xEF)
+			{
+				length = 3;
+				codepoint = lead & 0x0F;
+				secondMin = lead == 0xE0? 0xA0 : 0x80;
+				secondMax = lead == 0xED? 0x9F : 0xBF;
 			}
-			else if ((byte & 0b11111000u) == 0b11110000)
+			else if (lead >= 0xF0 && lead <= 0xF4)
 			{
-				i += 3;
-				if (i < in.size())
+				length = 4;
+				codepoint = lead & 0x07;
+				secondMin = lead == 0xF0? 0x90 : 0x80;
+				secondMax = lead == 0xF4? 0x8F : 0xBF;
+			}
+			else
+			{
+				*dst++ = CReplacementCharacter;
+				src++;
+				continue;
+			}
+
+			auto consumed = 1u;
+			for (; consumed < length && src + consumed < end; ++consumed)
+			{
+				auto byte = src[consumed];
+				auto low = consumed == 1? secondMin : Byte(0x80);
+				auto high = consumed == 1? secondMax : Byte(0xBF);
+				if (byte < low || byte > high)
 				{
-					auto c0 = I32(in[i] & 0b00111111);
-					auto c1 = I32(in[i - 1] & 0b00111111) << 6;
-					auto c2 = I32(in[i - 2] & 0b00111111) << 12;
-					auto c3 = I32(byte & 0b00000111) << 18;
-					codepoints.push_back(c0 | c1 | c2 | c3);
+					break;
 				}
+				codepoint = (codepoint << 6) | (byte & 0x3F);
 			}
+
+			*dst++ = consumed == length? codepoint : CReplacementCharacter;
+			src += consumed;
 		}
+
+		return dst - out.data();
+	}
+
+
+	inline auto DecodeUTF8(Span<const Byte> in) -> Array<I32>
+	{
+		Array<I32> codepoints(in.size());
+		codepoints.resize(DecodeUTF8(in, Span<I32>(codepoints)));
 		return codepoints;
 	}
-}
\ No newline at end of file
+}
@@ -27,6 +27,7 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <bit>
 
 #include "types.hpp"
 #include "concepts.hpp"
@@ -52,6 +53,20 @@ namespace WL
 
 	template <typename T>
 	inline auto LowerBound(const Array<T>& sortedArray, const T& value) -> U32;
+
+	template <typename TTo, typename TFrom>
+	inline auto BitCast(const TFrom& v) -> TTo;
+
+	// Raw serialization of trivially copyable values, ReadBytes advances the
+	// span and returns false when it's too short.
+	template <typename T>
+	inline auto WriteBytes(Array<Byte>& out, const T& value) -> V;
+	template <typename T>
+	inline auto WriteBytes(Array<Byte>& out, Span<const T> values) -> V;
+	template <typename T>
+	inline auto ReadBytes(Span<const Byte>& in, T& value) -> B;
+	template <typename T>
+	inline auto ReadBytes(Span<const Byte>& in, Span<T> values) -> B;
 }
 
 
@@ -123,4 +138,43 @@ namespace WL
 
 		return first;
 	}
-}
\ No newline at end of file
+
+	template <typename TTo, typename TFrom>
+	inline auto BitCast(const TFrom& v) -> TTo
+	{
+		return std::bit_cast<TTo>(v);
+	}
+
+	template <typename T>
+	inline auto WriteBytes(Array<Byte>& out, const T& value) -> V
+	{
+		WriteBytes(out, Span<const T>(&value, 1));
+	}
+
+	template <typename T>
+	inline auto WriteBytes(Array<Byte>& out, Span<const T> values) -> V
+	{
+		auto offset = out.size();
+		out.resize(offset + values.size_bytes());
+		memcpy(out.data() + offset, values.data(), values.size_bytes());
+	}
+
+	template <typename T>
+	inline auto ReadBytes(Span<const Byte>& in, T& value) -> B
+	{
+		return ReadBytes(in, Span<T>(&value, 1));
+	}
+
+	template <typename T>
+	inline auto ReadBytes(Span<const Byte>& in, Span<T> values) -> B
+	{
+		if (in.size() < values.size_bytes())
+		{
+			return false;
+		}
+
+		memcpy(values.data(), in.data(), values.size_bytes());
+		in = in.subspan(values.size_bytes());
+		return true;
+	}
+}
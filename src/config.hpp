@@ -25,9 +25,48 @@
 
 #include <common/types.hpp>
 #include <common/unicode.hpp>
+#include <common/disk_cache.hpp>
 
 namespace WL
 {
+	struct DynamicResolutionConfig
+	{
+		B enabled = false;
+		// Frame budget the resolution scale is adapted to.
+		F32 targetFrameTimeMs = 16.667f;
+		F32 minScale = 0.5f;
+		F32 maxScale = 1.f;
+		F32 scaleStep = 0.125f;
+		// The averaged frame time has to stay above/below these fractions of the
+		// budget for the given number of frames before the scale is changed.
+		F32 downscaleThreshold = 1.15f;
+		F32 upscaleThreshold = 1.05f;
+		U32 downscaleFrames = 15;
+		U32 upscaleFrames = 120;
+		// Render the text of the topmost layer in a separate full resolution
+		// pass after upscaling. Text on the layers below is drawn with the
+		// scene so the layers above it still cover it.
+		B fullResolutionText = true;
+	};
+
+	enum class EAntiAliasing
+	{
+		// Only the coverage computed by the shaders, no multisampling.
+		Analytic = 0,
+		MSAA,
+		AlphaToCoverage
+	};
+
+	struct AntiAliasingConfig
+	{
+		EAntiAliasing mode = EAntiAliasing::Analytic;
+		U32 samples = 4;
+		// Halve the sample count when over the frame budget from
+		// DynamicResolutionConfig, before lowering the resolution.
+		B adaptiveSamples = true;
+		U32 minSamples = 1;
+	};
+
 	struct Config
 	{
 		Str appName = "web-lightning";
@@ -36,11 +75,22 @@ namespace WL
 
 		U32 defaultFontHeight = 16;
 		Array<UnicodeRange> defaultFontRanges;
+		// Heights besides defaultFontHeight to build atlases for at startup.
+		Array<U32> extraFontHeights;
 
 		B useFontAtlases = true;
+		// Build one signed distance field atlas per font, used for all heights,
+		// instead of a coverage atlas for defaultFontHeight.
+		B useSDFFontAtlases = false;
+		// Persist font atlases and SVG rasters between runs.
+		B useDiskCache = true;
+		Str diskCacheDirectory = DiskCache::CDefaultDirectory;
 		B borderlessWindow = false;
 		B resizableWindow = true;
 
+		DynamicResolutionConfig dynamicResolution;
+		AntiAliasingConfig antiAliasing;
+
 		inline Config();
 	};
 }
@@ -30,7 +30,10 @@
 
 namespace WL
 {
+	static constexpr I32 CDefaultLizardLevel = 10;
+
 	inline auto DecompressLizard(Span<const Byte> data) -> Array<Byte>;
+	inline auto CompressLizard(Span<const Byte> data, I32 level = CDefaultLizardLevel) -> Array<Byte>;
 }
 
 
@@ -79,4 +82,24 @@ namespace WL
 		LizardF_freeDecompressionContext(ctx);
 		return result;
 	}
-}
\ No newline at end of file
+
+
+	auto CompressLizard(Span<const Byte> src, I32 level) -> Array<Byte>
+	{
+		LizardF_preferences_t preferences = {};
+		preferences.compressionLevel = level;
+		preferences.frameInfo.contentSize = src.size();
+
+		Array<Byte> result(LizardF_compressFrameBound(src.size(), &preferences));
+		auto compressedSize = LizardF_compressFrame(result.data(), result.size(), src.data(), src.size(), &preferences);
+
+		if (LizardF_isError(compressedSize))
+		{
+			result.clear();
+			return result;
+		}
+
+		result.resize(compressedSize);
+		return result;
+	}
+}
@@ -29,6 +29,11 @@ namespace WL
 {
 #ifdef WL_USE_EMBEDDED_FONT
 	static constexpr U32 OpenSansSize = 130836;
-	extern const Byte OpenSans[OpenSansSize];
+	static constexpr U32 OpenSansLizardSize = 81134;
+	extern const Byte OpenSansLizard[OpenSansLizardSize];
+
+	// The embedded font is stored Lizard compressed and inflated on the
+	// first call.
+	auto GetEmbeddedFont() -> Span<const Byte>;
 #endif
 }
\ No newline at end of file
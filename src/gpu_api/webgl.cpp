@@ -53,6 +53,8 @@ namespace WL
         context = SDL_GL_CreateContext(w);
         InitWebGLApi();
 
+        WebGLPso::parallelCompileSupported = SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile");
+
         return context != nullptr;
     }
 
@@ -77,6 +79,18 @@ namespace WL
         glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
     }
 
+    auto WebGL::DisableSampleCoverage() -> V
+    {
+        glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+    }
+
+    auto WebGL::GetMaxSamples() -> U32
+    {
+        GLint result;
+        glGetIntegerv(GL_MAX_SAMPLES, &result);
+        return result;
+    }
+
     auto WebGL::GetAttachedFrameBufferID() -> U32
     {
         GLint result;
@@ -53,6 +53,8 @@ namespace WL
         static auto ClearPresentSurface() -> V;
         static auto EnablePresentSurfaceTransparency() -> V;
         static auto EnableSampleCoverage() -> V;
+        static auto DisableSampleCoverage() -> V;
+        static auto GetMaxSamples() -> U32;
         static auto GetAttachedFrameBufferID() -> U32;
         static auto Present() -> V;
         static auto UpdateViewport(U32 width, U32 height, U32 x = 0, U32 y = 0) -> V;
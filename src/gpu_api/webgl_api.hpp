@@ -41,4 +41,8 @@ namespace WL
 #endif
 
 	static inline constexpr U32 CInvalidID = U32(~0u);
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 }
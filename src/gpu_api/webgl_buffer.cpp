@@ -54,6 +54,11 @@ namespace WL
 		return true;
 	}
 
+	auto WebGLBuffer::BindUniform(U32 binding) const -> V
+	{
+		WEBGL_VALIDATE(glBindBufferBase(GL_UNIFORM_BUFFER, binding, id));
+	}
+
 	auto WebGLBuffer::Update(const Byte* data, U32 size) -> V
 	{
 		WEBGL_VALIDATE(glBindBuffer(GL_COPY_WRITE_BUFFER, id));
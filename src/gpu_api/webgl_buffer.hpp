@@ -39,6 +39,7 @@ namespace WL
 		auto Allocate(U32 size, B onGPU = true, EUsage usage = EUsage::Undefined) -> B;
 		auto Reallocate(U32 size, B onGPU = true, EUsage usage = EUsage::Undefined) -> B;
 		auto GetNativeId() const -> GLuint { return id; }
+		auto BindUniform(U32 binding) const -> V;
 
 		template <typename T>
 		auto Update(const Array<T>& a) -> V;
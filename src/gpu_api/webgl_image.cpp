@@ -61,19 +61,24 @@ namespace WL
 		height = h;
 		depth = d;
 
-		glBindTexture(GL_TEXTURE_2D, id);
+		// Integer textures can't be filtered and float ones only with an
+		// extension, they are fetched by texel anyway.
+		auto filter = (format == EFormat::RGBA32 || format == EFormat::RGBA32Float)? GL_NEAREST : GL_LINEAR;
+
 		if (depth > 1)
 		{
-			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
 			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 		}
 		else
 		{
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glBindTexture(GL_TEXTURE_2D, id);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		}
@@ -104,12 +109,12 @@ namespace WL
 		if (img != nullptr)
 		{
 			Allocate(img->format, img->width, img->height, 1);
-			InitData((V*)img->data.data());
+			InitData(img->data.data());
 		}
 	}
 
 
-	auto WebGLImage::InitData(V* inData) -> V
+	auto WebGLImage::InitData(const V* inData) -> V
 	{
 
 		auto glFormat = gFormatToGLFormat[U32(format)];
@@ -130,7 +135,7 @@ namespace WL
 	}
 
 
-	auto WebGLImage::UpdateData(const Extent& extent, void* inData) -> V
+	auto WebGLImage::UpdateData(const Extent& extent, const V* inData) -> V
 	{
 		auto glFormat = gFormatToGLFormat[U32(format)];
 		auto glType = gFormatToGLType[U32(format)];
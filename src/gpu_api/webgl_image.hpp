@@ -37,8 +37,8 @@ namespace WL
 	public:
 		WebGLImage(const RawCPUImage* cpuImage = nullptr);
 		auto Allocate(EFormat format, U32 w, U32 h = 1, U32 d = 1) -> B;
-		auto InitData(V* inData) -> V;
-		auto UpdateData(const Extent& extend, void* inData) -> V;
+		auto InitData(const V* inData) -> V;
+		auto UpdateData(const Extent& extend, const V* inData) -> V;
 
 		auto GetNativeId() const -> GLuint { return id; }
 
@@ -31,7 +31,7 @@
 
 namespace WL
 {
-    WebGLPso::WebGLPso() : program(CInvalidID), vao(CInvalidID)
+    WebGLPso::WebGLPso() : program(CInvalidID), vao(CInvalidID), compileState(ECompileState::NotStarted)
     {
         Fill(ubSlots, -1);
         Fill(texSlots, -1);
@@ -49,26 +49,112 @@ namespace WL
 
 
     auto WebGLPso::Compile() -> B
+    {
+        return BeginCompile() && FinishCompile();
+    }
+
+
+    auto WebGLPso::BeginCompile() -> B
     {
         B status = true;
 
+        // Resubmitted after a failed initialization.
+        if (program != CInvalidID)
+        {
+            glDeleteProgram(program);
+            glDeleteVertexArrays(1, &vao);
+        }
+
         glGenVertexArrays(1, &vao);
 
         this->program = glCreateProgram();
 
         for (auto& shader : shaders)
         {
-            status = status && shader.Compile();
+            status = status && shader.BeginCompile();
             glAttachShader(program, shader.GetNativeId());
         }
 
+        // Linking doesn't wait for the compilation, the status queries do.
         glLinkProgram(program);
+
+        WEBGL_VALIDATE(glBindVertexArray(vao));
+
+        compileState = status ? ECompileState::Pending : ECompileState::Failed;
+        return status;
+    }
+
+
+    auto WebGLPso::IsReady() -> B
+    {
+        if (compileState == ECompileState::Pending)
+        {
+            if (parallelCompileSupported)
+            {
+                GLint completed = GL_FALSE;
+                glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+                if (completed != GL_TRUE)
+                {
+                    return false;
+                }
+            }
+
+            FinishCompile();
+        }
+
+        return compileState == ECompileState::Done;
+    }
+
+
+    auto WebGLPso::FinishCompile() -> B
+    {
+        if (compileState != ECompileState::Pending)
+        {
+            return compileState == ECompileState::Done;
+        }
+
+        B status = true;
+
+        for (auto& shader : shaders)
+        {
+            status = status && shader.CheckCompileStatus();
+        }
+
         GLint linkingDone = 0;
         glGetProgramiv(program, GL_LINK_STATUS, &linkingDone);
 
-        WEBGL_VALIDATE(glBindVertexArray(vao));
+        if (status && linkingDone != GL_TRUE)
+        {
+            GLint length = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+            Str error;
+            error.resize(length);
+            glGetProgramInfoLog(program, length, &length, error.data());
+            LogError("Program link error: ", error);
+        }
+
+        status = status && (linkingDone == GL_TRUE);
+
+        if (status)
+        {
+            for (U32 binding = 0; binding < blockNames.size(); ++binding)
+            {
+                if (blockNames[binding].empty())
+                {
+                    continue;
+                }
+
+                auto blockIndex = glGetUniformBlockIndex(program, blockNames[binding].c_str());
+                // Blocks which are not referenced by the shaders are inactive.
+                if (blockIndex != GL_INVALID_INDEX)
+                {
+                    WEBGL_VALIDATE(glUniformBlockBinding(program, blockIndex, binding));
+                }
+            }
+        }
 
-        return status && (linkingDone == GL_TRUE);
+        compileState = status ? ECompileState::Done : ECompileState::Failed;
+        return status;
     }
 
     auto WebGLPso::Use() -> V
@@ -131,6 +217,12 @@ namespace WL
     }
 
 
+    auto WebGLPso::AddUniformBlock(U32 binding, const C* name) -> V
+    {
+        blockNames[binding] = name;
+    }
+
+
     auto WebGLPso::UpdateConstant(U32 slot, F32 v) -> V
     {
         GetUBLocation(slot);
@@ -193,6 +285,8 @@ namespace WL
 
     auto WebGLPso::BindTexture(const WebGLImage& tex, U32 slot) -> V
     {
+        WEBGL_VALIDATE(glActiveTexture(GL_TEXTURE0 + slot));
+
         if (tex.depth > 1)
         {
             WEBGL_VALIDATE(glBindTexture(GL_TEXTURE_2D_ARRAY, tex.GetNativeId()));
@@ -201,7 +295,6 @@ namespace WL
         {
             WEBGL_VALIDATE(glBindTexture(GL_TEXTURE_2D, tex.GetNativeId()));
         }
-        WEBGL_VALIDATE(glActiveTexture(GL_TEXTURE0 + slot));
 
         if (texSlots[slot] == -1)
         {
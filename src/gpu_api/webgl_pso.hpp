@@ -40,11 +40,22 @@ namespace WL
         WebGLPso();
         ~WebGLPso();
 
+        // Compiles and links synchronously.
         auto Compile() -> B;
+        // Submits all shaders and the link to the driver without querying
+        // their status, so the driver can compile the programs of multiple
+        // PSOs in parallel.
+        auto BeginCompile() -> B;
+        // Doesn't block when KHR_parallel_shader_compile is available,
+        // otherwise waits for the compilation to finish.
+        auto IsReady() -> B;
+        auto FinishCompile() -> B;
         auto Use() -> V;
         auto AddVBLayout(const VBLayout& layout) -> V;
         auto AddSimpleConstant(U32 slot, EType type, const C* = "") -> V;
         auto AddTexture(U32 slot, const C* = "") -> V;
+        // The block is bound to the binding once the program is linked.
+        auto AddUniformBlock(U32 binding, const C* name) -> V;
         auto UpdateConstant(U32 slot, F32 v) -> V;
         auto UpdateConstant(U32 slot, Vec2 v) -> V;
         auto UpdateConstant(U32 slot, Vec3 v) -> V;
@@ -55,11 +66,22 @@ namespace WL
         auto AddShader(const C* source, U32 size, EShaderType type) -> V;
         auto DrawInstanced(U32 first, U32 count, U32 instances) -> V;
 
+        inline static B parallelCompileSupported = false;
+
         private:
         auto GetUBLocation(U32 slot) -> V;
 
+        enum class ECompileState
+        {
+            NotStarted,
+            Pending,
+            Done,
+            Failed
+        };
+
         GLuint program;
         GLuint vao;
+        ECompileState compileState;
         StaticArray<WebGLShader, (U32) EShaderType::Count> shaders;
         StaticArray<VBLayout, CMaxVBSlots> vbLayouts;
 
@@ -67,6 +89,7 @@ namespace WL
         StaticArray<I32, CMaxTextureSlots> texSlots;
         StaticArray<Str, CMaxUBSlots> ubNames;
         StaticArray<I32, CMaxUBSlots> ubSlots;
+        StaticArray<Str, CMaxUBSlots> blockNames;
     };
 
 }
@@ -99,6 +99,14 @@ namespace WL
 		WEBGL_VALIDATE(glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
 	}
 
+	auto WebGLRenderTarget::BlitTo(const WebGLRenderTarget& other, U32 srcWidth, U32 srcHeight, U32 dstWidth, U32 dstHeight, B linearFilter) const -> V
+	{
+		auto filter = linearFilter ? GL_LINEAR : GL_NEAREST;
+		WEBGL_VALIDATE(glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBufferID));
+		WEBGL_VALIDATE(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, other.frameBufferID));
+		WEBGL_VALIDATE(glBlitFramebuffer(0, 0, srcWidth, srcHeight, 0, 0, dstWidth, dstHeight, GL_COLOR_BUFFER_BIT, filter));
+	}
+
 	auto WebGLRenderTarget::Recreate(U32 width, U32 height, U32 samples, B withDepth) -> V
 	{
 		Destroy();
@@ -119,14 +127,17 @@ namespace WL
 		if (colorBufferID != CInvalidID)
 		{
 			glDeleteRenderbuffers(1, &colorBufferID);
+			colorBufferID = CInvalidID;
 		}
 		if (depthBufferID != CInvalidID)
 		{
 			glDeleteRenderbuffers(1, &depthBufferID);
+			depthBufferID = CInvalidID;
 		}
 		if (frameBufferID != CInvalidID)
 		{
 			glDeleteFramebuffers(1, &frameBufferID);
+			frameBufferID = CInvalidID;
 		}
 	}
 }
@@ -36,6 +36,10 @@ namespace WL
 		auto Wrap(NativeID frameBufferID) -> V;
 		auto Bind() -> V;
 		auto BlitTo(const WebGLRenderTarget& other) const -> V;
+		auto BlitTo(const WebGLRenderTarget& other, U32 srcWidth, U32 srcHeight, U32 dstWidth, U32 dstHeight, B linearFilter = true) const -> V;
+		auto GetWidth() const -> U32 { return width; }
+		auto GetHeight() const -> U32 { return height; }
+		auto GetSamples() const -> U32 { return samples; }
 		auto Recreate(U32 width, U32 height, U32 samples = 1, B withDepth = true) -> V;
 		~WebGLRenderTarget();
 	private:
@@ -43,6 +47,6 @@ namespace WL
 		NativeID frameBufferID = CInvalidID;
 		NativeID colorBufferID = CInvalidID;
 		NativeID depthBufferID = CInvalidID;
-		B wrapped;
+		B wrapped = false;
 	};
 }
\ No newline at end of file
@@ -44,6 +44,11 @@ namespace WL
     }
 
     auto WebGLShader::Compile() -> B
+    {
+        return BeginCompile() && CheckCompileStatus();
+    }
+
+    auto WebGLShader::BeginCompile() -> B
     {
         static const GLenum typeTable[] =
         {
@@ -51,11 +56,11 @@ namespace WL
             GL_FRAGMENT_SHADER
         };
 
-        static const C* nameTable[] =
+        // Resubmitted by a pso whose previous compilation failed.
+        if (id != 0)
         {
-            "Vertex",
-            "Fragment"
-        };
+            glDeleteShader(id);
+        }
 
         id = glCreateShader(typeTable[(U32)type]);
         
@@ -68,6 +73,23 @@ namespace WL
         GLsizei size = sourceSize;
         glShaderSource(id, 1, &data, &size);
         glCompileShader(id);
+
+        return true;
+    }
+
+    auto WebGLShader::CheckCompileStatus() -> B
+    {
+        static const C* nameTable[] =
+        {
+            "Vertex",
+            "Fragment"
+        };
+
+        if (id == 0)
+        {
+            return false;
+        }
+
         GLint result;
         glGetShaderiv(id, GL_COMPILE_STATUS, &result);
 
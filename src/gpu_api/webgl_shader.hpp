@@ -38,6 +38,9 @@ namespace WL
 
         auto AddSource(const C* source, U32 sourceSize, EShaderType type) -> V;
         auto Compile() -> B;
+        // Submits the source to the driver without waiting for the result.
+        auto BeginCompile() -> B;
+        auto CheckCompileStatus() -> B;
 
         auto GetNativeId() const -> GLuint { return id; }
 
@@ -27,6 +27,9 @@
 #include <common/time.hpp>
 #include <algebra/algebra.hpp>
 
+#include <config.hpp>
+#include <shaders/common.hpp>
+
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
@@ -52,6 +55,8 @@ namespace WL
         U32 keyCode;
         B leftPressed = false;
         B leftReleased = false;
+        // Wheel steps since the last update, positive away from the user.
+        F32 wheelY = 0.f;
     };
 
     template <class TGPUAPI>
@@ -71,11 +76,19 @@ namespace WL
         static auto AddPreRenderingCode(const PreRenderFunction& func) -> V;
         static auto AddUpdateCode(const UpdateFunction& func) -> V;
         static auto AddRenderingCode(const RenderFunction& func) -> V;
+        static auto AddOverlayRenderingCode(const RenderFunction& func) -> V;
+
+        static auto EnableDynamicResolution(const DynamicResolutionConfig& cfg) -> V;
+        static auto EnableAntiAliasing(const AntiAliasingConfig& cfg) -> V;
+        static auto GetResolutionScale() -> F32;
+        static auto GetSamples() -> U32;
 
         static auto GetAspectRatio() -> F32;
         static auto SetClearColor(const Color4& color) -> V;
         static auto EnableTransparency() -> V;
         static auto GetDimensions() -> Vec2;
+        static auto GetDpiScale() -> F32;
+        static auto SetViewTransform(const Mat4x4& transform) -> V;
         static auto MoveWindowUnits(Vec2 u) -> V;
         static auto RegisterWindowDragArea(Vec4 area) -> V;
         static auto RegisterWindowDragExcludedArea(Vec4 area, U32 idx) -> V;
@@ -100,17 +113,31 @@ namespace WL
         private:
         static auto PresentLoopIteration() -> V;
         static auto ProcessInput() -> UpdateState;
+        static auto BeginScenePass() -> V;
+        static auto EndScenePass() -> V;
+        static auto AdaptToFrameTime(F32 dt) -> V;
+        static auto UpdateDpiScale() -> V;
+        // Called once per pass, since the render dimensions differ between
+        // the scene and the overlay.
+        static auto UpdateFrameConstants() -> V;
+        static auto LowerQuality() -> V;
+        static auto RaiseQuality() -> V;
 
         inline static SDL_Window* window = nullptr;
         inline static RenderFunction renderFunction = [](){};
         inline static UpdateFunction updateFunction = [](const UpdateState& updateState) {};
         inline static PreRenderFunction preRenderFunction = [](F32 dt){};
+        inline static RenderFunction overlayRenderFunction = [](){};
 
         inline static F64 timeStamp = 0;
+        inline static F64 startTimeStamp = 0;
 
         inline static U32 width = 0;
         inline static U32 height = 0;
-        inline static U32 samples = 8;
+        // Dimensions of the target the current pass renders into.
+        inline static U32 renderWidth = 0;
+        inline static U32 renderHeight = 0;
+        inline static U32 samples = 1;
         inline static B isWindowClosed = false;
         inline static Color4 clearColor = Color4(0.0f, 0.0f, 0.0f, 0.0f);
 
@@ -124,6 +151,30 @@ namespace WL
         inline static U32 excludedControlAreas = 0;
 
         inline static GPUAPI::RenderTarget presentTarget;
+
+        inline static GPUAPI::Buffer frameConstantsBuffer;
+        inline static F32 dpiScale = 1.f;
+        inline static Mat4x4 viewTransform = Mat4x4(
+            1.f, 0.f, 0.f, 0.f,
+            0.f, 1.f, 0.f, 0.f,
+            0.f, 0.f, 1.f, 0.f,
+            0.f, 0.f, 0.f, 1.f
+        );
+
+        // The scene target is allocated at full window resolution and the
+        // scene is rendered into its lower left corner, so changing the scale
+        // doesn't require reallocation.
+        inline static GPUAPI::RenderTarget sceneTarget;
+        // Single sampled copy of the scene used when a multisampled scene
+        // has to be upscaled, since resolving blits can't scale.
+        inline static GPUAPI::RenderTarget resolveTarget;
+        inline static B sceneIsOffscreen = false;
+        inline static DynamicResolutionConfig dynamicResolution;
+        inline static AntiAliasingConfig antiAliasing;
+        inline static F32 resolutionScale = 1.f;
+        inline static F32 averageFrameTimeMs = 0.f;
+        inline static U32 framesOverBudget = 0;
+        inline static U32 framesUnderBudget = 0;
     };
 }
 
@@ -150,6 +201,8 @@ namespace WL
 
         width = w? w : GetCanvasWidth();
         height = h? h : GetCanvasHeight();
+        renderWidth = width;
+        renderHeight = height;
 
         U32 extraFlags = 0;
         extraFlags |= resizableWindow ? SDL_WINDOW_RESIZABLE : 0;
@@ -159,6 +212,10 @@ namespace WL
         SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
         SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
         SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+        // Multisampling is done offscreen (if enabled) so the sample count
+        // can be changed at runtime.
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
+        SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 0);
 
         window = SDL_CreateWindow(
             appName.c_str(),
@@ -193,7 +250,17 @@ namespace WL
         TGPUAPI::SetPresentSurfaceClearColor(clearColor);
         auto presentBufferID = TGPUAPI::GetAttachedFrameBufferID();
         presentTarget.Wrap(presentBufferID);
+
+        if (!frameConstantsBuffer.Allocate(sizeof(FrameConstants), false))
+        {
+            isWindowClosed = true;
+            return false;
+        }
+        frameConstantsBuffer.BindUniform(CFrameConstantsBinding);
+        UpdateDpiScale();
+
         timeStamp = GetTimeStampUS();
+        startTimeStamp = timeStamp;
         return true;
     }
 
@@ -234,6 +301,7 @@ namespace WL
                 width = event.window.data1;
                 height = event.window.data2;
                 TGPUAPI::UpdateViewport(width, height);
+                UpdateDpiScale();
             }
 
             if (event.type == SDL_KEYDOWN)
@@ -262,6 +330,17 @@ namespace WL
                 }
             }
 
+            if (event.type == SDL_MOUSEWHEEL)
+            {
+                auto direction = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED? -1.f : 1.f;
+                us.wheelY += event.wheel.y * direction;
+
+                I32 x, y;
+                SDL_GetMouseState(&x, &y);
+                us.mouseX = x / F32(width);
+                us.mouseY = y / F32(width);
+            }
+
             if (event.type == SDL_MOUSEMOTION)
             {
                 us.mouseX = event.motion.x / F32(width);
@@ -284,8 +363,171 @@ namespace WL
         auto updateState = ProcessInput();
         updateFunction(updateState);
         preRenderFunction(updateState.dt);
+        BeginScenePass();
         renderFunction();
+        EndScenePass();
         TGPUAPI::Present();
+        AdaptToFrameTime(updateState.dt);
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::BeginScenePass() -> V
+    {
+        sceneIsOffscreen = resolutionScale < 1.f || samples > 1;
+
+        if (!sceneIsOffscreen)
+        {
+            renderWidth = width;
+            renderHeight = height;
+            UpdateFrameConstants();
+            return;
+        }
+
+        if (sceneTarget.GetWidth() != width || sceneTarget.GetHeight() != height || sceneTarget.GetSamples() != samples)
+        {
+            sceneTarget.Recreate(width, height, samples, false);
+        }
+
+        renderWidth = Max(1u, U32(width * resolutionScale));
+        renderHeight = Max(1u, U32(height * resolutionScale));
+        sceneTarget.Bind();
+        TGPUAPI::UpdateViewport(renderWidth, renderHeight);
+        UpdateFrameConstants();
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::EndScenePass() -> V
+    {
+        if (sceneIsOffscreen)
+        {
+            auto scaled = renderWidth != width || renderHeight != height;
+
+            if (scaled && samples > 1)
+            {
+                if (resolveTarget.GetWidth() != width || resolveTarget.GetHeight() != height)
+                {
+                    resolveTarget.Recreate(width, height, 1, false);
+                }
+                sceneTarget.BlitTo(resolveTarget, renderWidth, renderHeight, renderWidth, renderHeight, false);
+                resolveTarget.BlitTo(presentTarget, renderWidth, renderHeight, width, height);
+            }
+            else
+            {
+                sceneTarget.BlitTo(presentTarget, renderWidth, renderHeight, width, height, scaled);
+            }
+
+            presentTarget.Bind();
+            TGPUAPI::UpdateViewport(width, height);
+            renderWidth = width;
+            renderHeight = height;
+            UpdateFrameConstants();
+        }
+
+        overlayRenderFunction();
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::UpdateDpiScale() -> V
+    {
+        I32 windowWidth, windowHeight;
+        I32 drawableWidth, drawableHeight;
+        SDL_GetWindowSize(window, &windowWidth, &windowHeight);
+        SDL_GL_GetDrawableSize(window, &drawableWidth, &drawableHeight);
+        dpiScale = windowWidth? F32(drawableWidth) / F32(windowWidth) : 1.f;
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::UpdateFrameConstants() -> V
+    {
+        FrameConstants constants =
+        {
+            .screenDims = GetDimensions(),
+            .time = F32((timeStamp - startTimeStamp) / 1000000.0),
+            .dpiScale = dpiScale,
+            .viewTransform = viewTransform
+        };
+        frameConstantsBuffer.Update((const Byte*)&constants, sizeof(constants));
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::AdaptToFrameTime(F32 dt) -> V
+    {
+        auto adaptiveSamples = antiAliasing.adaptiveSamples && antiAliasing.mode != EAntiAliasing::Analytic;
+
+        if (!dynamicResolution.enabled && !adaptiveSamples)
+        {
+            return;
+        }
+
+        // Exponential moving average to filter out single frame spikes.
+        auto frameTimeMs = dt / 1000.f;
+        averageFrameTimeMs = Lerp(averageFrameTimeMs, frameTimeMs, 0.1f);
+
+        auto budget = dynamicResolution.targetFrameTimeMs;
+        if (averageFrameTimeMs > budget * dynamicResolution.downscaleThreshold)
+        {
+            framesOverBudget++;
+            framesUnderBudget = 0;
+        }
+        else if (averageFrameTimeMs < budget * dynamicResolution.upscaleThreshold)
+        {
+            framesUnderBudget++;
+            framesOverBudget = 0;
+        }
+        else
+        {
+            framesOverBudget = 0;
+            framesUnderBudget = 0;
+        }
+
+        if (framesOverBudget >= dynamicResolution.downscaleFrames)
+        {
+            LowerQuality();
+            framesOverBudget = 0;
+        }
+        else if (framesUnderBudget >= dynamicResolution.upscaleFrames)
+        {
+            RaiseQuality();
+            framesUnderBudget = 0;
+        }
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::LowerQuality() -> V
+    {
+        // Samples are cheaper to lose than resolution, so drop them first.
+        auto adaptiveSamples = antiAliasing.adaptiveSamples && antiAliasing.mode != EAntiAliasing::Analytic;
+
+        if (adaptiveSamples && samples > Max(1u, antiAliasing.minSamples))
+        {
+            samples = Max(Max(1u, antiAliasing.minSamples), samples / 2);
+        }
+        else if (dynamicResolution.enabled)
+        {
+            resolutionScale = Max(dynamicResolution.minScale, resolutionScale - dynamicResolution.scaleStep);
+        }
+    }
+
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::RaiseQuality() -> V
+    {
+        auto adaptiveSamples = antiAliasing.adaptiveSamples && antiAliasing.mode != EAntiAliasing::Analytic;
+
+        if (dynamicResolution.enabled && resolutionScale < dynamicResolution.maxScale)
+        {
+            resolutionScale = Min(dynamicResolution.maxScale, resolutionScale + dynamicResolution.scaleStep);
+        }
+        else if (adaptiveSamples && samples < antiAliasing.samples)
+        {
+            samples = Min(antiAliasing.samples, samples * 2);
+        }
     }
 
 
@@ -321,6 +563,72 @@ namespace WL
         renderFunction = func;
     }
 
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::AddOverlayRenderingCode(const RenderFunction& func) -> V
+    {
+        overlayRenderFunction = func;
+    }
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::EnableDynamicResolution(const DynamicResolutionConfig& cfg) -> V
+    {
+        dynamicResolution = cfg;
+        resolutionScale = cfg.enabled ? cfg.maxScale : 1.f;
+        averageFrameTimeMs = cfg.targetFrameTimeMs;
+        framesOverBudget = 0;
+        framesUnderBudget = 0;
+    }
+
+    template <class TGPUAPI>
+    auto PresentSurface<TGPUAPI>::EnableAntiAliasing(const AntiAliasingConfig& cfg) -> V
+    {
+        antiAliasing = cfg;
+        averageFrameTimeMs = dynamicResolution.targetFrameTimeMs;
+
+        if (cfg.mode == EAntiAliasing::Analytic)
+        {
+            samples = 1;
+            TGPUAPI::DisableSampleCoverage();
+            return;
+        }
+
+        antiAliasing.samples = Max(1u, Min(cfg.samples, TGPUAPI::GetMaxSamples()));
+        samples = antiAliasing.samples;
+
+        if (cfg.mode == EAntiAliasing::AlphaToCoverage)
+        {
+            TGPUAPI::EnableSampleCoverage();
+        }
+        else
+        {
+            TGPUAPI::DisableSampleCoverage();
+        }
+    }
+
+    template <class TGPUAPI>
+    inline auto PresentSurface<TGPUAPI>::GetResolutionScale() -> F32
+    {
+        return resolutionScale;
+    }
+
+    template <class TGPUAPI>
+    inline auto PresentSurface<TGPUAPI>::GetSamples() -> U32
+    {
+        return samples;
+    }
+
+    template <class TGPUAPI>
+    inline auto PresentSurface<TGPUAPI>::GetDpiScale() -> F32
+    {
+        return dpiScale;
+    }
+
+    template <class TGPUAPI>
+    inline auto PresentSurface<TGPUAPI>::SetViewTransform(const Mat4x4& transform) -> V
+    {
+        viewTransform = transform;
+    }
+
     template<class TGPUAPI>
     inline auto PresentSurface<TGPUAPI>::MoveWindowUnits(Vec2 u) -> V
     {
@@ -470,6 +778,6 @@ namespace WL
     template<class TGPUAPI>
     inline auto PresentSurface<TGPUAPI>::GetDimensions() -> Vec2
     {
-        return Vec2(width, height);
+        return Vec2(renderWidth, renderHeight);
     }
 }
\ No newline at end of file
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "bezier_renderer.hpp"
+#include "stroke.hpp"
 
 #include <algebra/bezier.hpp>
 #include <algebra/vector.hpp>
@@ -42,27 +43,43 @@ namespace WL
 		using Pso = GPUAPI::Pso;
 		using QuadraticBezier = QuadraticBezier<F32, 2>;
 
-		static auto Init() -> B;
+		static auto Init(U32 variant) -> B;
 		static auto AccumulateBezier(const QuadraticBezier& curve, ColorU32 color, F32 width, F32 feather = 1.0f, F32 fBegin = feather, F32 fEnd = feather) -> V;
+		static auto AccumulateBezier(const QuadraticBezier& curve, const StrokeSegment& stroke) -> V;
 		static auto CommitDrawCommands() -> V;
 		static auto Clear() -> V;
 
 		static constexpr U32 initialCurveInstancesCapacity = 1024;
 
 	private:
-		static auto AllocateBuffers() -> B;
-		static auto ReallocateBuffers(U32 newCapacity) -> B;
+		// Instances are bucketed by shader variant, see EStrokeFeature.
+		struct Batch
+		{
+			U32 instanceCapacity = initialCurveInstancesCapacity;
+			U32 instances = 0;
+			B initialized = false;
+			B joined = false;
+
+			Pso pso;
+			Buffer packedPointsAndColorBuffer;
+			Buffer widthAndFeathersBuffer;
+			Buffer neighboursBuffer;
+			Buffer flagsBuffer;
+
+			Array<UVec4> packedPointsAndColorBufferCPU;
+			Array<Vec4> widthAndFeathersBufferCPU;
+			Array<Vec4> neighboursBufferCPU;
+			Array<U32> flagsBufferCPU;
+		};
+
+		// Returns nullptr when the variant can't be initialized.
+		static auto AddInstance(U32 variant) -> Batch*;
+
+		static auto AllocateBuffers(Batch& batch) -> B;
+		static auto ReallocateBuffers(Batch& batch, U32 newCapacity) -> B;
 		static auto PackPoint(Vec2 point) -> U32;
 
-		inline static U32 instanceCapacity = initialCurveInstancesCapacity;
-		inline static U32 instances = 0;
-
-		inline static Pso pso;
-		inline static Buffer packedPointsAndColorBuffer;
-		inline static Buffer widthAndFeathersBuffer;
-
-		inline static Array<UVec4> packedPointsAndColorBufferCPU;
-		inline static Array<Vec4> widthAndFeathersBufferCPU;
+		inline static StaticArray<Batch, CBezierVariants> batches;
 	};
 }
 
@@ -70,34 +87,42 @@ namespace WL
 namespace WL
 {
 	template<typename TPresentSurface>
-	inline auto BezierRendererGPU<TPresentSurface>::Init() -> B
+	inline auto BezierRendererGPU<TPresentSurface>::Init(U32 variant) -> B
 	{
-		if (!AllocateBuffers())
+		auto& batch = batches[variant];
+		if (batch.initialized)
+		{
+			return true;
+		}
+		batch.joined = variant & U32(EStrokeFeature::Joined);
+
+		if (!AllocateBuffers(batch))
 		{
 			return false;
 		}
 
-		pso.AddShader(BezierApproxVert.data(), BezierApproxVert.size(), EShaderType::Vertex);
-		pso.AddShader(BezierApproxFrag.data(), BezierApproxFrag.size(), EShaderType::Fragment);
+		auto& vert = SpecializeShader(BezierApproxVert, variant, CStrokeFeatureNames);
+		auto& frag = SpecializeShader(BezierApproxFrag, variant, CStrokeFeatureNames);
+		batch.pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		batch.pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
 
-		pso.AddVBLayout({ .binding = 0, .type = EType::Uint, .components = 4 });
-		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
-		pso.AddSimpleConstant(0, EType::Float, "uScreenDims");
+		batch.pso.AddVBLayout({ .binding = 0, .type = EType::Uint, .components = 4 });
+		batch.pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
+		if (batch.joined)
+		{
+			batch.pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 4 });
+			batch.pso.AddVBLayout({ .binding = 3, .type = EType::Uint, .components = 1 });
+		}
+		batch.pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
 
-		return pso.Compile();
+		batch.initialized = batch.pso.BeginCompile();
+		return batch.initialized;
 	}
 
 
 	template<typename TPresentSurface>
 	inline auto BezierRendererGPU<TPresentSurface>::AccumulateBezier(const QuadraticBezier& curve, ColorU32 color, F32 width, F32 feather, F32 fBegin, F32 fEnd) -> V
 	{
-		instances++;
-		if (instances > instanceCapacity)
-		{
-			ReallocateBuffers(instanceCapacity * 2);
-			instanceCapacity *= 2;
-		}
-
 		auto p0 = PackPoint(curve.p0);
 		auto p1 = PackPoint(curve.p1);
 		auto p2 = PackPoint(curve.p2);
@@ -112,8 +137,82 @@ namespace WL
 			Swap(fBegin, fEnd);
 		}
 
-		packedPointsAndColorBufferCPU.emplace_back(p0, p1, p2, color.packed);
-		widthAndFeathersBufferCPU.emplace_back(width, feather, fBegin, fEnd);
+		U32 variant = 0;
+		if (feather > 0.f || fBegin > 0.f || fEnd > 0.f)
+		{
+			variant |= U32(EStrokeFeature::Feathered);
+		}
+		if (fBegin < 0.f)
+		{
+			variant |= U32(EStrokeFeature::CutBegin);
+		}
+		auto batchPtr = AddInstance(variant);
+		if (!batchPtr)
+		{
+			return;
+		}
+		auto& batch = *batchPtr;
+
+		batch.packedPointsAndColorBufferCPU.emplace_back(p0, p1, p2, color.packed);
+		batch.widthAndFeathersBufferCPU.emplace_back(width, feather, fBegin, fEnd);
+	}
+
+
+	template<typename TPresentSurface>
+	inline auto BezierRendererGPU<TPresentSurface>::AccumulateBezier(const QuadraticBezier& curve, const StrokeSegment& stroke) -> V
+	{
+		auto p0 = PackPoint(curve.p0);
+		auto p1 = PackPoint(curve.p1);
+		auto p2 = PackPoint(curve.p2);
+		auto oriented = stroke;
+
+		// Same as above, the ends swap along with the points.
+		auto dir0 = curve.p2 - curve.p1;
+		auto dir1 = curve.p1 - curve.p0;
+		if (HodgeDualWedge(dir0, dir1) < 0)
+		{
+			Swap(p0, p2);
+			Swap(oriented.widthBegin, oriented.widthEnd);
+			Swap(oriented.previous, oriented.next);
+			Swap(oriented.hasPrevious, oriented.hasNext);
+		}
+
+		auto variant = U32(EStrokeFeature::Joined);
+		if (stroke.feather > 0.f)
+		{
+			variant |= U32(EStrokeFeature::Feathered);
+		}
+		auto batchPtr = AddInstance(variant);
+		if (!batchPtr)
+		{
+			return;
+		}
+		auto& batch = *batchPtr;
+
+		batch.packedPointsAndColorBufferCPU.emplace_back(p0, p1, p2, stroke.color.packed);
+		batch.widthAndFeathersBufferCPU.emplace_back(oriented.widthBegin, stroke.feather, oriented.widthEnd, stroke.miterLimit);
+		batch.neighboursBufferCPU.emplace_back(oriented.previous[0], oriented.previous[1], oriented.next[0], oriented.next[1]);
+		batch.flagsBufferCPU.emplace_back(oriented.GetFlags());
+	}
+
+
+	template<typename TPresentSurface>
+	inline auto BezierRendererGPU<TPresentSurface>::AddInstance(U32 variant) -> Batch*
+	{
+		auto& batch = batches[variant];
+		if (!Init(variant))
+		{
+			return nullptr;
+		}
+
+		batch.instances++;
+		if (batch.instances > batch.instanceCapacity)
+		{
+			ReallocateBuffers(batch, batch.instanceCapacity * 2);
+			batch.instanceCapacity *= 2;
+		}
+
+		return &batch;
 	}
 
 
@@ -130,42 +229,66 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto BezierRendererGPU<TPresentSurface>::CommitDrawCommands() -> V
 	{
-		if (!instances)
+		for (auto& batch : batches)
 		{
-			return;
+			if (!batch.instances || !batch.pso.IsReady())
+			{
+				continue;
+			}
+
+			batch.packedPointsAndColorBuffer.Update(batch.packedPointsAndColorBufferCPU);
+			batch.widthAndFeathersBuffer.Update(batch.widthAndFeathersBufferCPU);
+			if (batch.joined)
+			{
+				batch.neighboursBuffer.Update(batch.neighboursBufferCPU);
+				batch.flagsBuffer.Update(batch.flagsBufferCPU);
+			}
+
+			batch.pso.Use();
+			batch.pso.BindVB(0, batch.packedPointsAndColorBuffer, true);
+			batch.pso.BindVB(1, batch.widthAndFeathersBuffer, true);
+			if (batch.joined)
+			{
+				batch.pso.BindVB(2, batch.neighboursBuffer, true);
+				batch.pso.BindVB(3, batch.flagsBuffer, true);
+			}
+
+
+			batch.pso.DrawInstanced(0, 3, batch.instances);
 		}
 
-		packedPointsAndColorBuffer.Update(packedPointsAndColorBufferCPU);
-		widthAndFeathersBuffer.Update(widthAndFeathersBufferCPU);
-
-		pso.Use();
-		pso.BindVB(0, packedPointsAndColorBuffer, true);
-		pso.BindVB(1, widthAndFeathersBuffer, true);
-
-		pso.UpdateConstant(0, PresentSurface::GetDimensions());
-
-		pso.DrawInstanced(0, 3, instances);
-
 		Clear();
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto BezierRendererGPU<TPresentSurface>::AllocateBuffers() -> B
+	inline auto BezierRendererGPU<TPresentSurface>::AllocateBuffers(Batch& batch) -> B
 	{
 		B status =
-			packedPointsAndColorBuffer.Allocate(initialCurveInstancesCapacity, false) &&
-			widthAndFeathersBuffer.Allocate(initialCurveInstancesCapacity, false);
+			batch.packedPointsAndColorBuffer.Allocate(initialCurveInstancesCapacity, false) &&
+			batch.widthAndFeathersBuffer.Allocate(initialCurveInstancesCapacity, false);
+		if (batch.joined)
+		{
+			status = status &&
+				batch.neighboursBuffer.Allocate(initialCurveInstancesCapacity, false) &&
+				batch.flagsBuffer.Allocate(initialCurveInstancesCapacity, false);
+		}
 		return status;
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto BezierRendererGPU<TPresentSurface>::ReallocateBuffers(U32 newCapacity) -> B
+	inline auto BezierRendererGPU<TPresentSurface>::ReallocateBuffers(Batch& batch, U32 newCapacity) -> B
 	{
 		B status =
-			packedPointsAndColorBuffer.Reallocate(newCapacity, false) &&
-			widthAndFeathersBuffer.Reallocate(newCapacity, false);
+			batch.packedPointsAndColorBuffer.Reallocate(newCapacity, false) &&
+			batch.widthAndFeathersBuffer.Reallocate(newCapacity, false);
+		if (batch.joined)
+		{
+			status = status &&
+				batch.neighboursBuffer.Reallocate(newCapacity, false) &&
+				batch.flagsBuffer.Reallocate(newCapacity, false);
+		}
 		return status;
 	}
 
@@ -173,8 +296,13 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto BezierRendererGPU<TPresentSurface>::Clear() -> V
 	{
-		instances = 0;
-		packedPointsAndColorBufferCPU.clear();
-		widthAndFeathersBufferCPU.clear();
+		for (auto& batch : batches)
+		{
+			batch.instances = 0;
+			batch.packedPointsAndColorBufferCPU.clear();
+			batch.widthAndFeathersBufferCPU.clear();
+			batch.neighboursBufferCPU.clear();
+			batch.flagsBufferCPU.clear();
+		}
 	}
 }
\ No newline at end of file
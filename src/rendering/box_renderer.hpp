@@ -59,25 +59,36 @@ namespace WL
 		static constexpr U32 initialBoxInstancesCapacity = 1024;
 
 	private:
-		static auto AllocateBuffers() -> B;
-		static auto ReallocateBuffers(U32 newCapacity) -> B;
+		// Instances are bucketed by shader variant so square boxes don't pay
+		// for the rounded corners evaluation.
+		struct Batch
+		{
+			U32 instanceCapacity = initialBoxInstancesCapacity;
+			U32 instances = 0;
+			B initialized = false;
+
+			Pso pso;
+			Buffer linearTransformsBuffer;
+			Buffer translationsBuffer;
+			Buffer colorsBuffer;
+			Buffer radiusesBuffer;
+
+			Array<Mat2x2> linearTransformsBufferCPU;
+			Array<Vec2> translationsBufferCPU;
+			Array<ColorU32> colorsBufferCPU;
+			Array<F32> radiusesBufferCPU;
+		};
+
+		static auto InitBatch(U32 variant) -> B;
+		static auto AllocateBuffers(Batch& batch) -> B;
+		static auto ReallocateBuffers(Batch& batch, U32 newCapacity) -> B;
 
 		inline static TexturedQuadRenderer texturedQuadRenderer;
 
-		inline static U32 instanceCapacity = initialBoxInstancesCapacity;
-		inline static U32 instances = 0;
+		inline static B initialized = false;
 
-		inline static Pso pso;
 		inline static Buffer positionsBuffer;
-		inline static Buffer linearTransformsBuffer;
-		inline static Buffer translationsBuffer;
-		inline static Buffer colorsBuffer;
-		inline static Buffer radiusesBuffer;
-
-		inline static Array<Mat2x2> linearTransformsBufferCPU;
-		inline static Array<Vec2> translationsBufferCPU;
-		inline static Array<ColorU32> colorsBufferCPU;
-		inline static Array<F32> radiusesBufferCPU;
+		inline static StaticArray<Batch, CQuadVariants> batches;
 
 		inline static Map<const Image*, Array<QuadDesc>> texturedDescs;
 	};
@@ -89,46 +100,82 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto BoxRenderer<TPresentSurface>::Init() -> B
 	{
-		if (!(texturedQuadRenderer.Init() && AllocateBuffers()))
+		if (initialized)
+		{
+			return true;
+		}
+
+		if (!positionsBuffer.Allocate(DefaultQuad2D::verticesCount))
 		{
 			return false;
 		}
 		positionsBuffer.Update((const Byte*)DefaultQuad2D::vertices, sizeof(DefaultQuad2D::vertices));
 
-		pso.AddShader(BoxVert.data(), BoxVert.size(), EShaderType::Vertex);
-		pso.AddShader(BoxFrag.data(), BoxFrag.size(), EShaderType::Fragment);
+		initialized = true;
+		return true;
+	}
+
+
+	template<typename TPresentSurface>
+	inline auto BoxRenderer<TPresentSurface>::InitBatch(U32 variant) -> B
+	{
+		auto& batch = batches[variant];
+
+		if (!AllocateBuffers(batch))
+		{
+			return false;
+		}
+
+		auto& vert = SpecializeShader(BoxVert, variant, CQuadFeatureNames);
+		auto& frag = SpecializeShader(BoxFrag, variant, CQuadFeatureNames);
+		batch.pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		batch.pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
 		
-		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 2 });
-		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
-		pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 2 });
-		pso.AddVBLayout({ .binding = 3, .type = EType::Uint, .components = 1 });
-		pso.AddVBLayout({ .binding = 4, .type = EType::Float, .components = 1 });
-		pso.AddSimpleConstant(0, EType::Float, "uScreenDims");
-
-		return pso.Compile();
+		batch.pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 2 });
+		batch.pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
+		batch.pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 2 });
+		batch.pso.AddVBLayout({ .binding = 3, .type = EType::Uint, .components = 1 });
+		batch.pso.AddVBLayout({ .binding = 4, .type = EType::Float, .components = 1 });
+		batch.pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
+
+		batch.initialized = batch.pso.BeginCompile();
+		return batch.initialized;
 	}
 
 
 	template<typename TPresentSurface>
 	inline auto BoxRenderer<TPresentSurface>::AccumulateBox(const QuadDesc& desc) -> V
 	{
+		if (!Init())
+		{
+			return;
+		}
+
 		if (desc.textured)
 		{
 			texturedDescs[desc.texture].push_back(desc);
 		}
 		else
 		{
-			instances++;
-			if (instances > instanceCapacity)
+			auto variant = (desc.radius > 0.f)? U32(EQuadFeature::Rounded) : 0u;
+			auto& batch = batches[variant];
+
+			if (!batch.initialized && !InitBatch(variant))
 			{
-				ReallocateBuffers(instanceCapacity * 2);
-				instanceCapacity *= 2;
+				return;
 			}
 
-			colorsBufferCPU.emplace_back(desc.color);
-			radiusesBufferCPU.emplace_back(desc.radius);
-			linearTransformsBufferCPU.emplace_back(desc.width / 2.f, 0.f, 0.f, desc.height / 2.f);
-			translationsBufferCPU.emplace_back(desc.offsetX, desc.offsetY);
+			batch.instances++;
+			if (batch.instances > batch.instanceCapacity)
+			{
+				ReallocateBuffers(batch, batch.instanceCapacity * 2);
+				batch.instanceCapacity *= 2;
+			}
+
+			batch.colorsBufferCPU.emplace_back(desc.color);
+			batch.radiusesBufferCPU.emplace_back(desc.radius);
+			batch.linearTransformsBufferCPU.emplace_back(desc.width / 2.f, 0.f, 0.f, desc.height / 2.f);
+			batch.translationsBufferCPU.emplace_back(desc.offsetX, desc.offsetY);
 		}
 	}
 
@@ -136,27 +183,30 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto BoxRenderer<TPresentSurface>::CommitDrawCommands() -> V
 	{
-		if (!instances && texturedDescs.empty())
+		for (auto& batch : batches)
 		{
-			return;
-		}
+			if (!batch.instances || !batch.pso.IsReady())
+			{
+				continue;
+			}
 
-		colorsBuffer.Update(colorsBufferCPU);
-		radiusesBuffer.Update(radiusesBufferCPU);
-		linearTransformsBuffer.Update(linearTransformsBufferCPU);
-		translationsBuffer.Update(translationsBufferCPU);
+			batch.colorsBuffer.Update(batch.colorsBufferCPU);
+			batch.radiusesBuffer.Update(batch.radiusesBufferCPU);
+			batch.linearTransformsBuffer.Update(batch.linearTransformsBufferCPU);
+			batch.translationsBuffer.Update(batch.translationsBufferCPU);
 
-		pso.Use();
-		pso.BindVB(0, positionsBuffer);
-		pso.BindVB(1, linearTransformsBuffer, true);
-		pso.BindVB(2, translationsBuffer, true);
-		pso.BindVB(3, colorsBuffer, true);
-		pso.BindVB(4, radiusesBuffer, true);
+			batch.pso.Use();
+			batch.pso.BindVB(0, positionsBuffer);
+			batch.pso.BindVB(1, batch.linearTransformsBuffer, true);
+			batch.pso.BindVB(2, batch.translationsBuffer, true);
+			batch.pso.BindVB(3, batch.colorsBuffer, true);
+			batch.pso.BindVB(4, batch.radiusesBuffer, true);
 
 
-		pso.UpdateConstant(0, PresentSurface::GetDimensions());
 
-		pso.DrawInstanced(0, DefaultQuad2D::verticesCount, instances);
+			batch.pso.DrawInstanced(0, DefaultQuad2D::verticesCount, batch.instances);
+		}
+
 		// Commit textured quads with the same texture to abuse instancing
 		// and reduce the number of draw calls.
 		for (auto& descsArray : texturedDescs)
@@ -173,26 +223,25 @@ namespace WL
 
 
 	template<typename TPresentSurface>
-	inline auto BoxRenderer<TPresentSurface>::AllocateBuffers() -> B
+	inline auto BoxRenderer<TPresentSurface>::AllocateBuffers(Batch& batch) -> B
 	{
 		B status =
-			positionsBuffer.Allocate(DefaultQuad2D::verticesCount) &&
-			linearTransformsBuffer.Allocate(initialBoxInstancesCapacity, false) &&
-			translationsBuffer.Allocate(initialBoxInstancesCapacity, false) &&
-			colorsBuffer.Allocate(initialBoxInstancesCapacity, false) &&
-			radiusesBuffer.Allocate(initialBoxInstancesCapacity, false);
+			batch.linearTransformsBuffer.Allocate(initialBoxInstancesCapacity, false) &&
+			batch.translationsBuffer.Allocate(initialBoxInstancesCapacity, false) &&
+			batch.colorsBuffer.Allocate(initialBoxInstancesCapacity, false) &&
+			batch.radiusesBuffer.Allocate(initialBoxInstancesCapacity, false);
 		return status;
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto BoxRenderer<TPresentSurface>::ReallocateBuffers(U32 newCapacity) -> B
+	inline auto BoxRenderer<TPresentSurface>::ReallocateBuffers(Batch& batch, U32 newCapacity) -> B
 	{
 		B status =
-			linearTransformsBuffer.Reallocate(newCapacity, false) &&
-			translationsBuffer.Reallocate(newCapacity, false) &&
-			colorsBuffer.Reallocate(newCapacity, false) &&
-			radiusesBuffer.Reallocate(newCapacity, false);
+			batch.linearTransformsBuffer.Reallocate(newCapacity, false) &&
+			batch.translationsBuffer.Reallocate(newCapacity, false) &&
+			batch.colorsBuffer.Reallocate(newCapacity, false) &&
+			batch.radiusesBuffer.Reallocate(newCapacity, false);
 		return status;
 	}
 
@@ -200,11 +249,14 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto BoxRenderer<TPresentSurface>::Clear() -> V
 	{
-		instances = 0;
-		colorsBufferCPU.clear();
-		radiusesBufferCPU.clear();
-		linearTransformsBufferCPU.clear();
-		translationsBufferCPU.clear();
+		for (auto& batch : batches)
+		{
+			batch.instances = 0;
+			batch.colorsBufferCPU.clear();
+			batch.radiusesBufferCPU.clear();
+			batch.linearTransformsBufferCPU.clear();
+			batch.translationsBufferCPU.clear();
+		}
 		texturedDescs.clear();
 	}
 }
\ No newline at end of file
@@ -59,6 +59,7 @@ namespace WL
 
 		inline static U32 instanceCapacity = initialArcInstancesCapacity;
 		inline static U32 instances = 0;
+		inline static B initialized = false;
 
 		inline static Pso pso;
 		inline static Buffer centersBuffer;
@@ -78,26 +79,38 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto CircularArcRenderer<TPresentSurface>::Init() -> B
 	{
+		if (initialized)
+		{
+			return true;
+		}
+
 		if (!AllocateBuffers())
 		{
 			return false;
 		}
 
-		pso.AddShader(CircularArcVert.data(), CircularArcVert.size(), EShaderType::Vertex);
-		pso.AddShader(CircularArcFrag.data(), CircularArcFrag.size(), EShaderType::Fragment);
+		auto& vert = SpecializeShader(CircularArcVert);
+		auto& frag = SpecializeShader(CircularArcFrag);
+		pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
 
 		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 2 });
 		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
 		pso.AddVBLayout({ .binding = 2, .type = EType::Uint, .components = 1 });
-		pso.AddSimpleConstant(0, EType::Float, "uScreenDims");
+		pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
 
-		return pso.Compile();
+		initialized = pso.BeginCompile();
+		return initialized;
 	}
 
 
 	template<typename TPresentSurface>
 	inline auto CircularArcRenderer<TPresentSurface>::AccumulateArc(Vec2 center, F32 radius, F32 width, F32 arcStart, F32 arcEnd, ColorU32 color) -> V
 	{
+		if (!Init())
+		{
+			return;
+		}
 
 		instances++;
 		if (instances > instanceCapacity)
@@ -120,6 +133,12 @@ namespace WL
 			return;
 		}
 
+		if (!pso.IsReady())
+		{
+			Clear();
+			return;
+		}
+
 		pso.Use();
 		colorsBuffer.Update(colorsBufferCPU);
 		paramsBuffer.Update(paramsBufferCPU);
@@ -129,7 +148,6 @@ namespace WL
 		pso.BindVB(1, paramsBuffer, true);
 		pso.BindVB(2, colorsBuffer, true);
 
-		pso.UpdateConstant(0, PresentSurface::GetDimensions());
 
 		pso.DrawInstanced(0, 3, instances);
 
@@ -23,11 +23,17 @@
 
 #pragma once
 
+#include <stb_rect_pack.h>
 #include <stb_truetype.h>
 
 #include <common/types.hpp>
 #include <common/unicode.hpp>
 #include <common/memory.hpp>
+#include <common/logging.hpp>
+#include <common/thread_pool.hpp>
+#include <common/disk_cache.hpp>
+
+#include <algebra/arithmetic.hpp>
 
 #include <embedded/embedded_font.hpp>
 
@@ -35,6 +41,7 @@
 
 #include "font_rasterizer.hpp"
 #include "rasterized_font.hpp"
+#include "raster_cache.hpp"
 
 
 namespace WL
@@ -46,22 +53,109 @@ namespace WL
 		using GPUAPI = TGPUAPI;
 		using Image = typename RasterizedFont<GPUAPI>::Image;
 
-		static constexpr U32 CDefaultAtlasSize = 2048;
+		// Atlas pages start at the minimum size and grow until the glyphs
+		// fit, past the maximum the glyphs spill onto more pages.
+		static constexpr U32 CMinAtlasSize = 64;
+		static constexpr U32 CMaxAtlasSize = 2048;
 		static constexpr U32 CDefaultAA = 2;
+		static constexpr U32 CAtlasPadding = 1;
+		// Horizontal pen positions subpixel glyphs are rasterized at.
+		static constexpr U32 CSubpixelPhases = 4;
+
+		// Height the distance fields are generated at, the glyph metrics of
+		// the SDF atlas are in pixels at that height.
+		static constexpr U32 CSDFBaseHeight = 48;
+		static constexpr U32 CSDFPadding = 6;
+		static constexpr U8 CSDFOnEdgeValue = 128;
 
 		inline static auto Init() -> B;
 		inline static auto AddFont(const Byte* fontData, U32 fontSize) -> U32;
 		inline static auto BuildAtlas(U32 fontIndex, U32 fontHeight, const Array<UnicodeRange>& ranges) -> V;
 		inline static auto BuildAtlases(U32 fontHeight, const Array<UnicodeRange>& ranges) -> V;
+		// Rasterizes one atlas per font and height on the thread pool, the
+		// uploads happen on the calling thread.
+		inline static auto BuildAtlases(const Array<U32>& fontHeights, const Array<UnicodeRange>& ranges) -> V;
+		inline static auto BuildSDFAtlas(U32 fontIndex, const Array<UnicodeRange>& ranges) -> V;
+		inline static auto BuildSDFAtlases(const Array<UnicodeRange>& ranges) -> V;
 		inline static auto GetRasterizedFont(U16 fontIndex) -> RasterizedFont<GPUAPI>&;
+		// Returns the glyph from the atlas of that height, the SDF atlas or
+		// the glyph cache, rasterizing it into the cache on a miss. Returns
+		// nullptr when the cache has no room left in this frame.
+		inline static auto GetGlyph(U32 fontIndex, U32 fontHeight, U32 codePoint) -> const AtlasGlyphDesc*;
+		// Returns the glyph rasterized without oversampling, shifted right by
+		// phase / CSubpixelPhases of a pixel. It always lives in the glyph
+		// cache and is rasterized on the first use of that phase.
+		inline static auto GetSubpixelGlyph(U32 fontIndex, U32 fontHeight, U32 codePoint, U32 phase) -> const AtlasGlyphDesc*;
+		// Glyphs prebuilt for that height, or the SDF ones if there are none.
+		// Misses have to go through GetGlyph.
+		inline static auto GetGlyphTable(U32 fontIndex, U32 fontHeight) -> const GlyphTable*;
+		inline static auto GetPage(U32 page) -> Image*;
+		// Layout metrics for a font with pixel height 1.
+		inline static auto GetAdvance(U32 fontIndex, U32 codePoint) -> F32;
+		inline static auto GetKerning(U32 fontIndex, U32 left, U32 right) -> F32;
+		inline static auto GetAscent(U32 fontIndex) -> F32;
+		inline static auto GetLineHeight(U32 fontIndex) -> F32;
+		// Changes whenever glyphs returned earlier may have moved.
+		inline static auto GetGeneration() -> U64;
+		inline static auto IsSDFPage(U32 page) -> B;
+		inline static auto IsCachePage(U32 page) -> B;
+		// Marks a glyph living in a cache page as used in this frame.
+		inline static auto TouchGlyph(U32 fontIndex, U32 fontHeight, U32 codePoint, U32 phase = 0) -> V;
+		// Glyphs returned before this call may be evicted after it.
+		inline static auto NextFrame() -> V;
 
 		inline static Set<U32> availableAtlases;
 
 	private:
 		static constexpr U32 CInitialFontCapacity = 128;
 
+		struct AtlasPage
+		{
+			U32 width;
+			U32 height;
+			Array<Byte> texels;
+		};
+
+		// Atlas rasterized on the CPU, waiting for its upload. The glyph
+		// pages index the atlas pages until then.
+		struct AtlasBitmap
+		{
+			U32 fontIndex;
+			U16 fontHeight;
+			B isSDF;
+			Array<AtlasPage> pages;
+			Array<Pair<U32, AtlasGlyphDesc>> glyphs;
+		};
+
+		inline static auto RasterizeAtlas(U32 fontIndex, U32 fontHeight, const Array<UnicodeRange>& ranges) -> AtlasBitmap;
+		inline static auto RasterizeSDFAtlas(U32 fontIndex, const Array<UnicodeRange>& ranges) -> AtlasBitmap;
+		inline static auto UploadAtlas(AtlasBitmap& atlas) -> V;
+		// Packs the rects on as few pages as possible, each trimmed to the
+		// packed extent. Returns the page of every rect, CNoPage for those
+		// which fit on no page.
+		inline static auto PackAtlasPages(Array<stbrp_rect>& rects, U32 padding, Array<AtlasPage>& pages) -> Array<U32>;
+
+		inline static auto InitMetrics(const stbtt_fontinfo& info, RasterizedFont<GPUAPI>& font) -> V;
+		inline static auto GetGlyphMetrics(U32 fontIndex, U32 codePoint) -> const typename RasterizedFont<GPUAPI>::GlyphMetrics&;
+		inline static auto GetGlyphCacheKey(U32 fontIndex, U32 fontHeight, U32 codePoint, U32 phase) -> U64;
+		inline static auto GetAtlasCacheKey(U32 fontIndex, U32 fontHeight, B isSDF, const Array<UnicodeRange>& ranges) -> U64;
+		inline static auto LoadAtlas(U64 key, AtlasBitmap& atlas) -> B;
+		inline static auto StoreAtlas(U64 key, const AtlasBitmap& atlas) -> V;
+
 		inline static Array<RasterizedFont<GPUAPI>> fonts;
 		inline static Array<stbtt_fontinfo> fontInfos;
+		// Hashes of the font files, part of the disk cache keys.
+		inline static Array<U64> fontHashes;
+
+		inline static Array<Image*> pages;
+		inline static Array<B> pageIsSDF;
+		inline static Array<B> pageIsCache;
+
+		inline static RasterCache<GPUAPI> glyphCache;
+		inline static Array<U32> cachePageToPage;
+		// Keyed by codepoint, phase, height and font index, the metrics
+		// outlive the cache slots and only the atlas location is refreshed.
+		inline static Map<U64, AtlasGlyphDesc> cachedGlyphs;
 
 	};
 }
@@ -77,10 +171,12 @@ namespace WL
 	#ifdef WL_USE_EMBEDDED_FONT
 		stbtt_fontinfo info;
 		
-		if (stbtt_InitFont(&info, OpenSans, 0))
+		auto embeddedFont = GetEmbeddedFont();
+		if (stbtt_InitFont(&info, embeddedFont.data(), 0))
 		{
 			fontInfos.push_back(info);
-			fonts.emplace_back();
+			fontHashes.push_back(DiskCache::Hash(embeddedFont));
+			InitMetrics(info, fonts.emplace_back());
 			return true;
 		}
 
@@ -98,6 +194,8 @@ namespace WL
 		if (stbtt_InitFont(&info, fontData, 0))
 		{
 			fontInfos.push_back(info);
+			fontHashes.push_back(DiskCache::Hash(Span<const Byte>(fontData, fontSize)));
+			InitMetrics(info, fonts.emplace_back());
 			return fontInfos.size() - 1;
 		}
 
@@ -108,9 +206,84 @@ namespace WL
 	template<typename TGPUAPI>
 	inline auto FontRasterizerCPU<TGPUAPI>::BuildAtlas(U32 fontIndex, U32 fontHeight, const Array<UnicodeRange>& ranges) -> V
 	{
+		auto atlas = RasterizeAtlas(fontIndex, fontHeight, ranges);
+		UploadAtlas(atlas);
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::BuildAtlases(U32 fontHeight, const Array<UnicodeRange>& ranges) -> V
+	{
+		BuildAtlases(Array<U32>{ fontHeight }, ranges);
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::BuildAtlases(const Array<U32>& fontHeights, const Array<UnicodeRange>& ranges) -> V
+	{
+		Array<AtlasBitmap> atlases(fonts.size() * fontHeights.size());
+
+		GetThreadPool().ParallelFor(
+			atlases.size(),
+			[&](U32 i)
+			{
+				atlases[i] = RasterizeAtlas(i / fontHeights.size(), fontHeights[i % fontHeights.size()], ranges);
+			}
+		);
+
+		for (auto& atlas : atlases)
+		{
+			UploadAtlas(atlas);
+		}
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::BuildSDFAtlas(U32 fontIndex, const Array<UnicodeRange>& ranges) -> V
+	{
+		auto atlas = RasterizeSDFAtlas(fontIndex, ranges);
+		UploadAtlas(atlas);
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::BuildSDFAtlases(const Array<UnicodeRange>& ranges) -> V
+	{
+		Array<AtlasBitmap> atlases(fonts.size());
+
+		GetThreadPool().ParallelFor(
+			atlases.size(),
+			[&](U32 i)
+			{
+				atlases[i] = RasterizeSDFAtlas(i, ranges);
+			}
+		);
+
+		for (auto& atlas : atlases)
+		{
+			UploadAtlas(atlas);
+		}
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::RasterizeAtlas(U32 fontIndex, U32 fontHeight, const Array<UnicodeRange>& ranges) -> AtlasBitmap
+	{
+		AtlasBitmap atlas =
+		{
+			.fontIndex = fontIndex,
+			.fontHeight = U16(fontHeight),
+			.isSDF = false,
+			.pages = {},
+			.glyphs = {}
+		};
+
+		auto cacheKey = GetAtlasCacheKey(fontIndex, fontHeight, false, ranges);
+		if (LoadAtlas(cacheKey, atlas))
+		{
+			return atlas;
+		}
+
+		auto& info = fontInfos[fontIndex];
+
+		// Only used for gathering and rendering, the packing is ours.
 		stbtt_pack_context spc;
-		Byte* bitmapData = Allocate(CDefaultAtlasSize * CDefaultAtlasSize);
-		stbtt_PackBegin(&spc, bitmapData, CDefaultAtlasSize, CDefaultAtlasSize, 0, 1, nullptr);
+		stbtt_PackBegin(&spc, nullptr, CMaxAtlasSize, CMaxAtlasSize, 0, CAtlasPadding, nullptr);
 		stbtt_PackSetOversampling(&spc, CDefaultAA, CDefaultAA);
 
 		Array<stbtt_packedchar> stbRangesCoords;
@@ -137,50 +310,472 @@ namespace WL
 			rangesCoordsPtr += stbRange.num_chars;
 		}
 
-		stbtt_PackFontRanges(&spc, fontInfos[fontIndex].data, 0, stbRanges.data(), stbRanges.size());
+		Array<stbrp_rect> rects(totalGlyphs);
+		stbtt_PackFontRangesGatherRects(&spc, &info, stbRanges.data(), stbRanges.size(), rects.data());
+		auto rectPages = PackAtlasPages(rects, CAtlasPadding, atlas.pages);
+
+		for (auto page = 0u; page < atlas.pages.size(); ++page)
+		{
+			auto& atlasPage = atlas.pages[page];
+			spc.pixels = atlasPage.texels.data();
+			spc.width = atlasPage.width;
+			spc.height = atlasPage.height;
+			spc.stride_in_bytes = atlasPage.width;
+
+			// Only the rects marked as packed get rendered.
+			for (auto i = 0u; i < rects.size(); ++i)
+			{
+				rects[i].was_packed = rectPages[i] == page;
+			}
+			stbtt_PackFontRangesRenderIntoRects(&spc, &info, stbRanges.data(), stbRanges.size(), rects.data());
+		}
 		stbtt_PackEnd(&spc);
 
+		atlas.glyphs.reserve(totalGlyphs);
+		auto rectIndex = 0u;
 		for (auto& r : stbRanges)
 		{
-			for (auto i = 0; i < r.num_chars; ++i)
+			for (auto i = 0; i < r.num_chars; ++i, ++rectIndex)
 			{
+				auto page = rectPages[rectIndex];
+				if (page == AtlasGlyphDesc::CNoPage)
+				{
+					continue;
+				}
+
 				auto cp = r.first_unicode_codepoint_in_range + i;
-				auto scale = 1.f / CDefaultAtlasSize;
+				auto uScale = 1.f / atlas.pages[page].width;
+				auto vScale = 1.f / atlas.pages[page].height;
 				AtlasGlyphDesc glyphDesc =
 				{
-					.u0 = r.chardata_for_range[i].x0 * scale,
-					.v0 = r.chardata_for_range[i].y0 * scale,
-					.u1 = r.chardata_for_range[i].x1 * scale,
-					.v1 = r.chardata_for_range[i].y1 * scale,
+					.u0 = r.chardata_for_range[i].x0 * uScale,
+					.v0 = r.chardata_for_range[i].y0 * vScale,
+					.u1 = r.chardata_for_range[i].x1 * uScale,
+					.v1 = r.chardata_for_range[i].y1 * vScale,
 					.xOffset0 = r.chardata_for_range[i].xoff,
 					.yOffset0 = r.chardata_for_range[i].yoff,
 					.xOffset1 = r.chardata_for_range[i].xoff2,
 					.yOffset1 = r.chardata_for_range[i].yoff2,
-					.xAdvance = r.chardata_for_range[i].xadvance
+					.xAdvance = r.chardata_for_range[i].xadvance,
+					.page = page
+				};
+				atlas.glyphs.emplace_back(cp, glyphDesc);
+			}
+		}
+
+		StoreAtlas(cacheKey, atlas);
+		return atlas;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::RasterizeSDFAtlas(U32 fontIndex, const Array<UnicodeRange>& ranges) -> AtlasBitmap
+	{
+		struct GlyphSDF
+		{
+			I32 codePoint;
+			Byte* bitmap;
+			I32 width;
+			I32 height;
+			I32 xOffset;
+			I32 yOffset;
+		};
+
+		AtlasBitmap atlas =
+		{
+			.fontIndex = fontIndex,
+			.fontHeight = RasterizedFont<GPUAPI>::CSDFHeight,
+			.isSDF = true,
+			.pages = {},
+			.glyphs = {}
+		};
+
+		auto cacheKey = GetAtlasCacheKey(fontIndex, CSDFBaseHeight, true, ranges);
+		if (LoadAtlas(cacheKey, atlas))
+		{
+			return atlas;
+		}
+
+		auto& info = fontInfos[fontIndex];
+		auto scale = stbtt_ScaleForPixelHeight(&info, CSDFBaseHeight);
+		auto pixelDistScale = F32(CSDFOnEdgeValue) / CSDFPadding;
+
+		Array<GlyphSDF> glyphs;
+		Array<stbrp_rect> rects;
+		for (auto& range : ranges)
+		{
+			for (auto cp = range.firstChar; cp <= range.lastChar; ++cp)
+			{
+				GlyphSDF glyph =
+				{
+					.codePoint = cp,
+					.bitmap = nullptr,
+					.width = 0,
+					.height = 0,
+					.xOffset = 0,
+					.yOffset = 0
 				};
-				fonts[fontIndex].codePointAndHeightToGlyph.emplace(U64(cp) | U64(fontHeight) << 32, glyphDesc);
+				glyph.bitmap = stbtt_GetCodepointSDF(
+					&info,
+					scale,
+					cp,
+					CSDFPadding,
+					CSDFOnEdgeValue,
+					pixelDistScale,
+					&glyph.width,
+					&glyph.height,
+					&glyph.xOffset,
+					&glyph.yOffset
+				);
+
+				stbrp_rect rect = {};
+				rect.id = I32(glyphs.size());
+				// Leave a texel between glyphs so filtering doesn't bleed.
+				rect.w = glyph.width + 1;
+				rect.h = glyph.height + 1;
+
+				glyphs.push_back(glyph);
+				rects.push_back(rect);
 			}
 		}
 
-		Image* atlas = new Image;
-		atlas->Allocate(EFormat::A8, CDefaultAtlasSize, CDefaultAtlasSize, 1);
-		atlas->InitData(bitmapData);
+		auto rectPages = PackAtlasPages(rects, 0, atlas.pages);
 
+		atlas.glyphs.reserve(glyphs.size());
+		for (auto i = 0u; i < rects.size(); ++i)
+		{
+			auto& rect = rects[i];
+			auto& glyph = glyphs[rect.id];
+			auto page = rectPages[i];
 
-		auto atlasIdx = fontIndex | (fontHeight << 16);
+			if (page != AtlasGlyphDesc::CNoPage)
+			{
+				auto& atlasPage = atlas.pages[page];
+				for (auto y = 0; y < glyph.height; ++y)
+				{
+					memcpy(atlasPage.texels.data() + (rect.y + y) * atlasPage.width + rect.x, glyph.bitmap + y * glyph.width, glyph.width);
+				}
+
+				I32 advance, leftSideBearing;
+				stbtt_GetCodepointHMetrics(&info, glyph.codePoint, &advance, &leftSideBearing);
+
+				auto uScale = 1.f / atlasPage.width;
+				auto vScale = 1.f / atlasPage.height;
+				AtlasGlyphDesc glyphDesc =
+				{
+					.u0 = rect.x * uScale,
+					.v0 = rect.y * vScale,
+					.u1 = (rect.x + glyph.width) * uScale,
+					.v1 = (rect.y + glyph.height) * vScale,
+					.xOffset0 = F32(glyph.xOffset),
+					.yOffset0 = F32(glyph.yOffset),
+					.xOffset1 = F32(glyph.xOffset + glyph.width),
+					.yOffset1 = F32(glyph.yOffset + glyph.height),
+					.xAdvance = advance * scale,
+					.page = page
+				};
+				atlas.glyphs.emplace_back(glyph.codePoint, glyphDesc);
+			}
+
+			if (glyph.bitmap)
+			{
+				stbtt_FreeSDF(glyph.bitmap, nullptr);
+			}
+		}
+
+		StoreAtlas(cacheKey, atlas);
+		return atlas;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::UploadAtlas(AtlasBitmap& atlas) -> V
+	{
+		auto firstPage = U32(pages.size());
+		auto& glyphTable = fonts[atlas.fontIndex].heightToGlyphs[atlas.fontHeight];
+		for (auto& [codePoint, glyphDesc] : atlas.glyphs)
+		{
+			glyphDesc.page += firstPage;
+			glyphTable.Append(codePoint, glyphDesc);
+		}
+
+		auto& atlasPages = fonts[atlas.fontIndex].heightToAtlasPages[atlas.fontHeight];
+		for (auto& atlasPage : atlas.pages)
+		{
+			Image* image = new Image;
+			image->Allocate(EFormat::A8, atlasPage.width, atlasPage.height, 1);
+			image->InitData(atlasPage.texels.data());
+			pages.push_back(image);
+			pageIsSDF.push_back(atlas.isSDF);
+			pageIsCache.push_back(false);
+			atlasPages.push_back(image);
+		}
+
+		auto atlasIdx = atlas.fontIndex | (atlas.fontHeight << 16);
 		availableAtlases.insert(atlasIdx);
-		fonts[fontIndex].heightToAtlas[fontHeight] = atlas;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::PackAtlasPages(Array<stbrp_rect>& rects, U32 padding, Array<AtlasPage>& pages) -> Array<U32>
+	{
+		Array<U32> rectPages(rects.size(), AtlasGlyphDesc::CNoPage);
+		Array<U32> remaining(rects.size());
+		for (auto i = 0u; i < rects.size(); ++i)
+		{
+			remaining[i] = i;
+		}
+
+		Array<stbrp_rect> pageRects;
+		Array<stbrp_node> nodes(CMaxAtlasSize);
+		while (!remaining.empty())
+		{
+			U64 area = 0;
+			for (auto i : remaining)
+			{
+				area += U64(rects[i].w) * rects[i].h;
+			}
+
+			// Start from the smallest square that could hold the rects and
+			// double the shorter side until they all fit or the page is full.
+			auto width = CMinAtlasSize;
+			while (U64(width) * width < area && width < CMaxAtlasSize)
+			{
+				width *= 2;
+			}
+			auto height = width;
+
+			while (true)
+			{
+				pageRects.clear();
+				for (auto i : remaining)
+				{
+					pageRects.push_back(rects[i]);
+				}
+
+				stbrp_context context;
+				stbrp_init_target(&context, width - padding, height - padding, nodes.data(), nodes.size());
+				if (stbrp_pack_rects(&context, pageRects.data(), pageRects.size()) || (width == CMaxAtlasSize && height == CMaxAtlasSize))
+				{
+					break;
+				}
+
+				if (width <= height)
+				{
+					width *= 2;
+				}
+				else
+				{
+					height *= 2;
+				}
+			}
+
+			auto page = U32(pages.size());
+			U32 usedWidth = 0;
+			U32 usedHeight = 0;
+			Array<U32> unpacked;
+			for (auto i = 0u; i < pageRects.size(); ++i)
+			{
+				auto& rect = pageRects[i];
+				if (rect.was_packed)
+				{
+					rects[remaining[i]] = rect;
+					rectPages[remaining[i]] = page;
+					usedWidth = Max(usedWidth, U32(rect.x + rect.w));
+					usedHeight = Max(usedHeight, U32(rect.y + rect.h));
+				}
+				else
+				{
+					unpacked.push_back(remaining[i]);
+				}
+			}
+
+			if (unpacked.size() == remaining.size())
+			{
+				LogError(unpacked.size(), " glyphs don't fit on an atlas page.");
+				break;
+			}
+
+			// A8 rows are uploaded with the default 4 byte unpack alignment.
+			usedWidth = (usedWidth + padding + 3) & ~3u;
+			usedHeight += padding;
+
+			pages.push_back(
+				{
+					.width = usedWidth,
+					.height = usedHeight,
+					.texels = Array<Byte>(usedWidth * usedHeight)
+				}
+			);
+			remaining = std::move(unpacked);
+		}
 
-		Deallocate(bitmapData);
+		return rectPages;
 	}
 
 	template<typename TGPUAPI>
-	inline auto FontRasterizerCPU<TGPUAPI>::BuildAtlases(U32 fontHeight, const Array<UnicodeRange>& ranges) -> V
+	inline auto FontRasterizerCPU<TGPUAPI>::InitMetrics(const stbtt_fontinfo& info, RasterizedFont<GPUAPI>& font) -> V
 	{
-		for (auto i = 0u; i < fonts.size(); ++i)
+		auto scale = stbtt_ScaleForPixelHeight(&info, 1.f);
+
+		I32 ascent, descent, lineGap;
+		stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+		font.ascent = ascent * scale;
+		font.descent = descent * scale;
+		font.lineGap = lineGap * scale;
+
+		// Pairs are looked up on demand, the stb_truetype linked through
+		// plutovg predates the kern table enumeration.
+		font.hasKerning = info.kern || info.gpos;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetGlyphMetrics(U32 fontIndex, U32 codePoint) -> const typename RasterizedFont<GPUAPI>::GlyphMetrics&
+	{
+		auto& font = fonts[fontIndex];
+		auto it = font.codePointToMetrics.find(codePoint);
+		if (it != font.codePointToMetrics.end())
 		{
-			BuildAtlas(i, fontHeight, ranges);
+			return it->second;
 		}
+
+		auto& info = fontInfos[fontIndex];
+		auto glyphIndex = stbtt_FindGlyphIndex(&info, codePoint);
+
+		I32 advance, leftSideBearing;
+		stbtt_GetGlyphHMetrics(&info, glyphIndex, &advance, &leftSideBearing);
+
+		typename RasterizedFont<GPUAPI>::GlyphMetrics metrics =
+		{
+			.glyphIndex = glyphIndex,
+			.xAdvance = advance * stbtt_ScaleForPixelHeight(&info, 1.f)
+		};
+		return font.codePointToMetrics.emplace(codePoint, metrics).first->second;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetGlyphCacheKey(U32 fontIndex, U32 fontHeight, U32 codePoint, U32 phase) -> U64
+	{
+		// Codepoints take at most 21 bits.
+		return U64(codePoint) | U64(phase) << 24 | U64(fontHeight) << 32 | U64(fontIndex) << 48;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetAtlasCacheKey(U32 fontIndex, U32 fontHeight, B isSDF, const Array<UnicodeRange>& ranges) -> U64
+	{
+		StaticArray<U32, 7> parameters =
+		{
+			fontHeight,
+			isSDF,
+			CMinAtlasSize,
+			CMaxAtlasSize,
+			isSDF? 0 : CDefaultAA,
+			isSDF? CSDFPadding : 0,
+			isSDF? U32(CSDFOnEdgeValue) : 0
+		};
+
+		auto key = DiskCache::HashValue(parameters, fontHashes[fontIndex]);
+		for (auto& range : ranges)
+		{
+			key = DiskCache::HashValue(range, key);
+		}
+
+		return key;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::LoadAtlas(U64 key, AtlasBitmap& atlas) -> B
+	{
+		auto data = DiskCache::Load(key);
+		Span<const Byte> in(data);
+
+		// Counts come from disk, check them against the remaining bytes
+		// before sizing anything with them.
+		U32 glyphCount;
+		if (!ReadBytes(in, glyphCount) || glyphCount > in.size() / (sizeof(U32) + sizeof(AtlasGlyphDesc)))
+		{
+			return false;
+		}
+
+		atlas.glyphs.resize(glyphCount);
+		for (auto& [codePoint, glyphDesc] : atlas.glyphs)
+		{
+			if (!ReadBytes(in, codePoint) || !ReadBytes(in, glyphDesc))
+			{
+				atlas.glyphs.clear();
+				return false;
+			}
+		}
+
+		U32 pageCount;
+		if (!ReadBytes(in, pageCount) || pageCount > in.size() / (2 * sizeof(U32)))
+		{
+			atlas.glyphs.clear();
+			return false;
+		}
+
+		for (auto& [codePoint, glyphDesc] : atlas.glyphs)
+		{
+			if (glyphDesc.page != AtlasGlyphDesc::CNoPage && glyphDesc.page >= pageCount)
+			{
+				atlas.glyphs.clear();
+				return false;
+			}
+		}
+
+		atlas.pages.resize(pageCount);
+		for (auto& page : atlas.pages)
+		{
+			if (!ReadBytes(in, page.width) || !ReadBytes(in, page.height) || page.width > CMaxAtlasSize || page.height > CMaxAtlasSize
+				|| page.width * page.height > in.size())
+			{
+				atlas.glyphs.clear();
+				atlas.pages.clear();
+				return false;
+			}
+
+			page.texels.resize(page.width * page.height);
+			if (!ReadBytes(in, Span<Byte>(page.texels)))
+			{
+				atlas.glyphs.clear();
+				atlas.pages.clear();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::StoreAtlas(U64 key, const AtlasBitmap& atlas) -> V
+	{
+		if (!DiskCache::IsEnabled())
+		{
+			return;
+		}
+
+		auto size = 2 * sizeof(U32) + atlas.glyphs.size() * (sizeof(U32) + sizeof(AtlasGlyphDesc));
+		for (auto& page : atlas.pages)
+		{
+			size += 2 * sizeof(U32) + page.texels.size();
+		}
+
+		Array<Byte> data;
+		data.reserve(size);
+
+		WriteBytes(data, U32(atlas.glyphs.size()));
+		for (auto& [codePoint, glyphDesc] : atlas.glyphs)
+		{
+			WriteBytes(data, codePoint);
+			WriteBytes(data, glyphDesc);
+		}
+
+		WriteBytes(data, U32(atlas.pages.size()));
+		for (auto& page : atlas.pages)
+		{
+			WriteBytes(data, page.width);
+			WriteBytes(data, page.height);
+			WriteBytes(data, Span<const Byte>(page.texels));
+		}
+
+		DiskCache::Store(key, data);
 	}
 
 	template<typename TGPUAPI>
@@ -188,4 +783,188 @@ namespace WL
 	{
 		return fonts[fontIndex];
 	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetGlyph(U32 fontIndex, U32 fontHeight, U32 codePoint) -> const AtlasGlyphDesc*
+	{
+		auto glyphTable = GetGlyphTable(fontIndex, fontHeight);
+		auto atlasGlyph = glyphTable? glyphTable->Find(codePoint) : nullptr;
+		if (atlasGlyph)
+		{
+			return atlasGlyph;
+		}
+
+		return GetSubpixelGlyph(fontIndex, fontHeight, codePoint, 0);
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetSubpixelGlyph(U32 fontIndex, U32 fontHeight, U32 codePoint, U32 phase) -> const AtlasGlyphDesc*
+	{
+		auto cacheKey = GetGlyphCacheKey(fontIndex, fontHeight, codePoint, phase);
+		auto cachedGlyph = cachedGlyphs.find(cacheKey);
+		if (cachedGlyph != cachedGlyphs.end() && cachedGlyph->second.xOffset0 == cachedGlyph->second.xOffset1)
+		{
+			// Whitespace, only the metrics are needed.
+			return &cachedGlyph->second;
+		}
+
+		auto slot = glyphCache.Find(cacheKey);
+		if (!slot)
+		{
+			auto& info = fontInfos[fontIndex];
+			auto scale = stbtt_ScaleForPixelHeight(&info, fontHeight);
+
+			I32 width, height, xOffset, yOffset;
+			auto shiftX = F32(phase) / CSubpixelPhases;
+			auto bitmap = stbtt_GetCodepointBitmapSubpixel(&info, scale, scale, shiftX, 0.f, codePoint, &width, &height, &xOffset, &yOffset);
+
+			if (cachedGlyph == cachedGlyphs.end())
+			{
+				I32 advance, leftSideBearing;
+				stbtt_GetCodepointHMetrics(&info, codePoint, &advance, &leftSideBearing);
+
+				AtlasGlyphDesc glyphDesc =
+				{
+					.u0 = 0.f,
+					.v0 = 0.f,
+					.u1 = 0.f,
+					.v1 = 0.f,
+					.xOffset0 = F32(xOffset),
+					.yOffset0 = F32(yOffset),
+					.xOffset1 = F32(xOffset + width),
+					.yOffset1 = F32(yOffset + height),
+					.xAdvance = advance * scale,
+					.page = AtlasGlyphDesc::CNoPage
+				};
+				cachedGlyph = cachedGlyphs.emplace(cacheKey, glyphDesc).first;
+			}
+
+			if (bitmap)
+			{
+				slot = glyphCache.Insert(cacheKey, bitmap, width, height);
+				stbtt_FreeBitmap(bitmap, nullptr);
+
+				if (!slot)
+				{
+					return nullptr;
+				}
+			}
+			else
+			{
+				return &cachedGlyph->second;
+			}
+
+			while (cachePageToPage.size() < glyphCache.GetPageCount())
+			{
+				cachePageToPage.push_back(pages.size());
+				pages.push_back(glyphCache.GetPage(cachePageToPage.size() - 1));
+				pageIsSDF.push_back(false);
+				pageIsCache.push_back(true);
+			}
+		}
+
+		auto uvScale = 1.f / glyphCache.GetPageSize();
+		auto& glyphDesc = cachedGlyph->second;
+		glyphDesc.u0 = slot->x * uvScale;
+		glyphDesc.v0 = slot->y * uvScale;
+		glyphDesc.u1 = (slot->x + slot->width) * uvScale;
+		glyphDesc.v1 = (slot->y + slot->height) * uvScale;
+		glyphDesc.page = cachePageToPage[slot->page];
+
+		return &glyphDesc;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetGlyphTable(U32 fontIndex, U32 fontHeight) -> const GlyphTable*
+	{
+		auto& heightToGlyphs = fonts[fontIndex].heightToGlyphs;
+
+		auto it = heightToGlyphs.find(fontHeight);
+		if (it == heightToGlyphs.end())
+		{
+			it = heightToGlyphs.find(RasterizedFont<GPUAPI>::CSDFHeight);
+		}
+
+		return it != heightToGlyphs.end()? &it->second : nullptr;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetPage(U32 page) -> Image*
+	{
+		return pages[page];
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetAdvance(U32 fontIndex, U32 codePoint) -> F32
+	{
+		return GetGlyphMetrics(fontIndex, codePoint).xAdvance;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetKerning(U32 fontIndex, U32 left, U32 right) -> F32
+	{
+		auto& font = fonts[fontIndex];
+		if (!font.hasKerning)
+		{
+			return 0.f;
+		}
+
+		auto leftGlyph = GetGlyphMetrics(fontIndex, left).glyphIndex;
+		auto rightGlyph = GetGlyphMetrics(fontIndex, right).glyphIndex;
+		auto key = U64(U32(leftGlyph)) | U64(U32(rightGlyph)) << 32;
+
+		auto it = font.kerningPairs.find(key);
+		if (it != font.kerningPairs.end())
+		{
+			return it->second;
+		}
+
+		auto& info = fontInfos[fontIndex];
+		auto kerning = stbtt_GetGlyphKernAdvance(&info, leftGlyph, rightGlyph) * stbtt_ScaleForPixelHeight(&info, 1.f);
+		font.kerningPairs.emplace(key, kerning);
+		return kerning;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetAscent(U32 fontIndex) -> F32
+	{
+		return fonts[fontIndex].ascent;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetLineHeight(U32 fontIndex) -> F32
+	{
+		auto& font = fonts[fontIndex];
+		return font.ascent - font.descent + font.lineGap;
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::GetGeneration() -> U64
+	{
+		return glyphCache.GetEvictionCount();
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::IsSDFPage(U32 page) -> B
+	{
+		return pageIsSDF[page];
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::IsCachePage(U32 page) -> B
+	{
+		return pageIsCache[page];
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::TouchGlyph(U32 fontIndex, U32 fontHeight, U32 codePoint, U32 phase) -> V
+	{
+		glyphCache.Find(GetGlyphCacheKey(fontIndex, fontHeight, codePoint, phase));
+	}
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerCPU<TGPUAPI>::NextFrame() -> V
+	{
+		glyphCache.NextFrame();
+	}
 }
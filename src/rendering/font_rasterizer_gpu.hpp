@@ -23,24 +23,81 @@
 
 #pragma once
 
+#include <stb_truetype.h>
+
 #include <common/types.hpp>
+#include <common/unicode.hpp>
+#include <common/utilities.hpp>
+#include <algebra/bezier.hpp>
+
 #include <embedded/embedded_font.hpp>
 
+#include <gpu_api/image.hpp>
+
 #include "font_rasterizer.hpp"
+#include "outline_font.hpp"
 
 
 namespace WL
 {
+	// Instead of rasterizing glyphs into atlases the quadratic outlines are
+	// uploaded to the GPU and the coverage is evaluated in the fragment
+	// shader, so text can be drawn at any scale without rebuilding anything.
+	//
+	// Curve texture (RGBA32F): two texels per curve, (p0, p1) and (p2, 0).
+	// Band texture (RGBA32UI): per glyph a header texel
+	// (band count, min y, 1 / band height, 0) followed by a texel per
+	// horizontal band (first list texel, curve count, 0, 0). The lists
+	// hold the curve texel indices of the curves crossing the band packed
+	// four per texel.
 	template <typename TGPUAPI>
 	class FontRasterizerGPU : FontRasterizer<FontRasterizerGPU<TGPUAPI>, TGPUAPI>
 	{
 	public:
 		using GPUAPI = TGPUAPI;
+		using Image = GPUAPI::Image;
+
+		// Texels per row of both textures, must match the text shaders.
+		static constexpr U32 CTextureWidth = 1024;
+		static constexpr U32 CBandCount = 8;
+		static constexpr F32 CCubicTolerance = 0.001f;
 
 		inline static auto Init() -> B;
 		inline static auto AddFont(const Byte* fontData, U32 fontSize) -> U32;
+		inline static auto BuildGlyphs(U32 fontIndex, const Array<UnicodeRange>& ranges) -> V;
+		// Outlines don't depend on the height, it's only there so this
+		// rasterizer can be used in place of the atlas based ones.
+		inline static auto BuildAtlases(U32 fontHeight, const Array<UnicodeRange>& ranges) -> V;
+		inline static auto BuildAtlases(const Array<U32>& fontHeights, const Array<UnicodeRange>& ranges) -> V;
+		inline static auto BuildSDFAtlases(const Array<UnicodeRange>& ranges) -> V;
+		inline static auto GetOutlineFont(U16 fontIndex) -> OutlineFont&;
+		// Layout metrics for a font with pixel height 1, the same interface
+		// as FontRasterizerCPU so TextLayout works with either.
+		inline static auto GetAdvance(U32 fontIndex, U32 codePoint) -> F32;
+		inline static auto GetKerning(U32 fontIndex, U32 left, U32 right) -> F32;
+		inline static auto GetAscent(U32 fontIndex) -> F32;
+		inline static auto GetLineHeight(U32 fontIndex) -> F32;
+		inline static auto GetCurveTexture() -> const Image*;
+		inline static auto GetBandTexture() -> const Image*;
+
+	private:
+		using QuadraticBezier = QuadraticBezier<F32, 2>;
+		using CubicBezier = CubicBezier<F32, 2>;
+
+		static constexpr U32 CInitialFontCapacity = 128;
+
+		inline static auto AddFontInfo(const stbtt_fontinfo& info) -> U32;
+		inline static auto AddGlyph(U32 fontIndex, I32 codePoint) -> V;
+		inline static auto UploadTextures() -> V;
+		inline static auto UploadTexels(Image*& texture, EFormat format, const V* texels, U32 count) -> V;
 
-		inline static Map<U64, typename GPUAPI::Image*> fontMaps;
+		inline static Array<OutlineFont> fonts;
+		inline static Array<stbtt_fontinfo> fontInfos;
+
+		inline static Array<Vec4> curveTexels;
+		inline static Array<UVec4> bandTexels;
+		inline static Image* curveTexture = nullptr;
+		inline static Image* bandTexture = nullptr;
 	};
 }
 
@@ -50,15 +107,320 @@ namespace WL
 	template<typename TGPUAPI>
 	inline auto FontRasterizerGPU<TGPUAPI>::Init() -> B
 	{
+		fonts.reserve(CInitialFontCapacity);
+
 	#ifdef WL_USE_EMBEDDED_FONT
+		stbtt_fontinfo info;
+
+		if (stbtt_InitFont(&info, GetEmbeddedFont().data(), 0))
+		{
+			AddFontInfo(info);
+			return true;
+		}
+
+		return false;
+	#else
+		return true;
 	#endif
-        return true;
 	}
 
 
 	template<typename TGPUAPI>
 	inline auto FontRasterizerGPU<TGPUAPI>::AddFont(const Byte* fontData, U32 fontSize) -> U32
 	{
+		stbtt_fontinfo info;
+		if (stbtt_InitFont(&info, fontData, 0))
+		{
+			return AddFontInfo(info);
+		}
+
 		return ~0u;
 	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::AddFontInfo(const stbtt_fontinfo& info) -> U32
+	{
+		I32 ascent, descent, lineGap;
+		stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+		auto scale = stbtt_ScaleForPixelHeight(&info, 1.f);
+
+		OutlineFont font;
+		font.ascent = ascent * scale;
+		font.descent = descent * scale;
+		font.lineGap = lineGap * scale;
+		font.hasKerning = info.kern || info.gpos;
+
+		fontInfos.push_back(info);
+		fonts.push_back(std::move(font));
+		return fontInfos.size() - 1;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::BuildGlyphs(U32 fontIndex, const Array<UnicodeRange>& ranges) -> V
+	{
+		for (auto& range : ranges)
+		{
+			for (auto cp = range.firstChar; cp <= range.lastChar; ++cp)
+			{
+				if (!fonts[fontIndex].codePointToGlyph.contains(cp))
+				{
+					AddGlyph(fontIndex, cp);
+				}
+			}
+		}
+
+		UploadTextures();
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::BuildAtlases(U32 fontHeight, const Array<UnicodeRange>& ranges) -> V
+	{
+		for (auto i = 0u; i < fonts.size(); ++i)
+		{
+			BuildGlyphs(i, ranges);
+		}
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::BuildAtlases(const Array<U32>& fontHeights, const Array<UnicodeRange>& ranges) -> V
+	{
+		// Outlines serve every height.
+		BuildAtlases(0, ranges);
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::BuildSDFAtlases(const Array<UnicodeRange>& ranges) -> V
+	{
+		BuildAtlases(0, ranges);
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::AddGlyph(U32 fontIndex, I32 codePoint) -> V
+	{
+		auto& info = fontInfos[fontIndex];
+		auto scale = stbtt_ScaleForPixelHeight(&info, 1.f);
+		auto glyphIndex = stbtt_FindGlyphIndex(&info, codePoint);
+
+		I32 advance, leftSideBearing;
+		stbtt_GetGlyphHMetrics(&info, glyphIndex, &advance, &leftSideBearing);
+
+		OutlineGlyphDesc desc = {};
+		desc.xAdvance = advance * scale;
+
+		stbtt_vertex* vertices = nullptr;
+		auto verticesCount = stbtt_GetGlyphShape(&info, glyphIndex, &vertices);
+
+		Array<QuadraticBezier> curves;
+		StaticArray<QuadraticBezier, CMaxQuadraticsPerCubic> approximation;
+		Vec2 current(0.f, 0.f);
+		for (auto i = 0; i < verticesCount; ++i)
+		{
+			auto& v = vertices[i];
+			Vec2 p(v.x * scale, v.y * scale);
+
+			switch (v.type)
+			{
+				case STBTT_vline:
+					// Lines are degenerate quadratics, the shader handles
+					// them with the linear root.
+					curves.emplace_back(current, (current + p) * 0.5f, p);
+					break;
+				case STBTT_vcurve:
+					curves.emplace_back(current, Vec2(v.cx * scale, v.cy * scale), p);
+					break;
+				case STBTT_vcubic:
+				{
+					CubicBezier cubic(current, Vec2(v.cx * scale, v.cy * scale), Vec2(v.cx1 * scale, v.cy1 * scale), p);
+					auto count = ApproximateByQuadratics(cubic, CCubicTolerance, Span<QuadraticBezier>(approximation));
+					curves.insert(curves.end(), approximation.begin(), approximation.begin() + count);
+					break;
+				}
+				default:
+					break;
+			}
+
+			current = p;
+		}
+
+		stbtt_FreeShape(&info, vertices);
+
+		if (!curves.empty())
+		{
+			desc.x0 = desc.y0 = 1e30f;
+			desc.x1 = desc.y1 = -1e30f;
+			for (auto& curve : curves)
+			{
+				for (auto& point : curve.points)
+				{
+					desc.x0 = Min(desc.x0, point[0]);
+					desc.y0 = Min(desc.y0, point[1]);
+					desc.x1 = Max(desc.x1, point[0]);
+					desc.y1 = Max(desc.y1, point[1]);
+				}
+			}
+
+			auto firstCurveTexel = U32(curveTexels.size());
+			for (auto& curve : curves)
+			{
+				curveTexels.emplace_back(curve.p0[0], curve.p0[1], curve.p1[0], curve.p1[1]);
+				curveTexels.emplace_back(curve.p2[0], curve.p2[1], 0.f, 0.f);
+			}
+
+			auto bandHeight = Max(desc.y1 - desc.y0, 1e-6f) / CBandCount;
+			StaticArray<Array<U32>, CBandCount> bands;
+			for (auto i = 0u; i < curves.size(); ++i)
+			{
+				auto& curve = curves[i];
+				auto minY = Min(curve.p0[1], Min(curve.p1[1], curve.p2[1]));
+				auto maxY = Max(curve.p0[1], Max(curve.p1[1], curve.p2[1]));
+				auto firstBand = U32(Max(0.f, (minY - desc.y0) / bandHeight));
+				auto lastBand = Min(CBandCount - 1, U32(Max(0.f, (maxY - desc.y0) / bandHeight)));
+
+				for (auto band = firstBand; band <= lastBand; ++band)
+				{
+					bands[band].push_back(firstCurveTexel + 2 * i);
+				}
+			}
+
+			desc.bandsOffset = U32(bandTexels.size());
+			desc.curveCount = U32(curves.size());
+
+			bandTexels.emplace_back(CBandCount, BitCast<U32>(desc.y0), BitCast<U32>(1.f / bandHeight), 0u);
+			auto bandHeadersOffset = bandTexels.size();
+			bandTexels.resize(bandTexels.size() + CBandCount, UVec4(0u, 0u, 0u, 0u));
+
+			for (auto band = 0u; band < CBandCount; ++band)
+			{
+				auto& curveIndices = bands[band];
+				bandTexels[bandHeadersOffset + band] = UVec4(U32(bandTexels.size()), U32(curveIndices.size()), 0u, 0u);
+
+				for (auto i = 0u; i < curveIndices.size(); i += 4)
+				{
+					UVec4 packed(0u, 0u, 0u, 0u);
+					for (auto j = 0u; j < 4 && i + j < curveIndices.size(); ++j)
+					{
+						packed[j] = curveIndices[i + j];
+					}
+					bandTexels.push_back(packed);
+				}
+			}
+		}
+
+		fonts[fontIndex].codePointToGlyph[codePoint] = desc;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::UploadTextures() -> V
+	{
+		UploadTexels(curveTexture, EFormat::RGBA32Float, curveTexels.data(), curveTexels.size());
+		UploadTexels(bandTexture, EFormat::RGBA32, bandTexels.data(), bandTexels.size());
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::UploadTexels(Image*& texture, EFormat format, const V* texels, U32 count) -> V
+	{
+		auto rows = Max(1u, (count + CTextureWidth - 1) / CTextureWidth);
+
+		// The last row is padded, so the data is copied.
+		Array<Byte> data(rows * CTextureWidth * 16, 0);
+		if (count)
+		{
+			memcpy(data.data(), texels, count * 16);
+		}
+
+		if (texture == nullptr)
+		{
+			texture = new Image;
+			texture->Allocate(format, CTextureWidth, rows, 1);
+		}
+		// InitData respecifies the storage of the same texture.
+		texture->height = rows;
+
+		texture->InitData(data.data());
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetOutlineFont(U16 fontIndex) -> OutlineFont&
+	{
+		return fonts[fontIndex];
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetAdvance(U32 fontIndex, U32 codePoint) -> F32
+	{
+		auto& font = fonts[fontIndex];
+		auto it = font.codePointToGlyph.find(codePoint);
+		if (it != font.codePointToGlyph.end())
+		{
+			return it->second.xAdvance;
+		}
+
+		// Not built, the renderer skips it but the layout still advances.
+		auto& info = fontInfos[fontIndex];
+		I32 advance, leftSideBearing;
+		stbtt_GetCodepointHMetrics(&info, codePoint, &advance, &leftSideBearing);
+		return advance * stbtt_ScaleForPixelHeight(&info, 1.f);
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetKerning(U32 fontIndex, U32 left, U32 right) -> F32
+	{
+		auto& font = fonts[fontIndex];
+		if (!font.hasKerning)
+		{
+			return 0.f;
+		}
+
+		auto key = U64(left) | U64(right) << 32;
+		auto it = font.kerningPairs.find(key);
+		if (it != font.kerningPairs.end())
+		{
+			return it->second;
+		}
+
+		auto& info = fontInfos[fontIndex];
+		auto kerning = stbtt_GetCodepointKernAdvance(&info, left, right) * stbtt_ScaleForPixelHeight(&info, 1.f);
+		font.kerningPairs.emplace(key, kerning);
+		return kerning;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetAscent(U32 fontIndex) -> F32
+	{
+		return fonts[fontIndex].ascent;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetLineHeight(U32 fontIndex) -> F32
+	{
+		auto& font = fonts[fontIndex];
+		return font.ascent - font.descent + font.lineGap;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetCurveTexture() -> const Image*
+	{
+		return curveTexture;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto FontRasterizerGPU<TGPUAPI>::GetBandTexture() -> const Image*
+	{
+		return bandTexture;
+	}
 }
@@ -30,8 +30,11 @@
 
 #include <rendering/color.hpp>
 #include <rendering/quad.hpp>
+#include <rendering/rasterized_font.hpp>
+#include <rendering/text_layout.hpp>
 
 #include <shaders/common.hpp>
+#include <shaders/variants.hpp>
 
 #include <gpu_api/shader.hpp>
 #include <gpu_api/pso.hpp>
@@ -58,23 +61,33 @@ namespace WL
 		using Image = GPUAPI::Image;
 		static auto Init() -> B;
 		static auto AccumulateDrawState(const Array<I32> codepoints, const FontRendererOptions& options) -> V;
+		// Draws a laid out run at the offset of the options, the font and
+		// height are the ones it was laid out with.
+		static auto AccumulateGlyphRun(GlyphRun& run, const FontRendererOptions& options) -> V;
 		static auto CommitDrawCommands() -> V;
 		static auto Clear() -> V;
 
 	private:
-		static auto AllocateBuffers(U32 atlasIdx) -> B;
-		static auto ReallocateBuffers(U32 atlasIdx, U32 newCapacity) -> B;
+		static auto InitPso(U32 variant) -> B;
+		struct Buffers;
+		static auto GetBuffers(U32 page) -> Buffers*;
+		static auto ResolveQuads(GlyphRun& run) -> V;
+		static auto AllocateBuffers(U32 page) -> B;
+		static auto ReallocateBuffers(U32 page, U32 newCapacity) -> B;
 
 
 		inline static constexpr U32 initialGlyphInstancesCapacity = 1024;
-		inline static U32 instanceCapacity = initialGlyphInstancesCapacity;
 		inline static U32 instances = 0;
+		inline static B initialized = false;
 
-		inline static GPUAPI::Pso pso;
+		// One PSO per atlas kind, coverage atlases use variant 0.
+		inline static StaticArray<typename GPUAPI::Pso, CFontVariants> psos;
+		inline static StaticArray<B, CFontVariants> psosInitialized = {};
 
 		struct Buffers
 		{
 			Image* atlas;
+			U32 instanceCapacity = initialGlyphInstancesCapacity;
 			Buffer linearTransformsBuffer;
 			Buffer translationsBuffer;
 			Buffer uvsBuffer;
@@ -86,9 +99,10 @@ namespace WL
 			Array<ColorU32> colorsBufferCPU;
 		};
 
-		inline static Map<U32, Buffers*> atlasIdxToBuffers;
+		// Glyphs are batched by the rasterizer page they live in.
+		inline static Map<U32, Buffers*> pageToBuffers;
 
-		inline static Set<U32> usedAtlases;
+		inline static Set<U32> usedPages;
 	};
 }
 
@@ -97,68 +111,289 @@ namespace WL
 	template <typename TPresentSurface, typename TRasterizer>
 	auto FontRenderer<TPresentSurface, TRasterizer>::Init() -> B
 	{
-		for (auto atlasIdx : Rasterizer::availableAtlases)
+		if (initialized)
 		{
-			if (!AllocateBuffers(atlasIdx))
-			{
-				return false;
-			}
+			return true;
+		}
+
+		initialized = InitPso(0);
+		return initialized;
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRenderer<TPresentSurface, TRasterizer>::InitPso(U32 variant) -> B
+	{
+		if (psosInitialized[variant])
+		{
+			return true;
 		}
 
-		pso.AddShader(FontAtlasTextVert.data(), FontAtlasTextVert.size(), EShaderType::Vertex);
-		pso.AddShader(FontAtlasTextFrag.data(), FontAtlasTextFrag.size(), EShaderType::Fragment);
+		auto& pso = psos[variant];
+		auto& vert = SpecializeShader(FontAtlasTextVert, variant, CFontFeatureNames);
+		auto& frag = SpecializeShader(FontAtlasTextFrag, variant, CFontFeatureNames);
+		pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
 
 		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
 		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 2 });
 		pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 4 });
 		pso.AddVBLayout({ .binding = 3, .type = EType::Float, .components = 1 });
 
-		pso.AddTexture(0, "uTexture0");
-
-		return pso.Compile();
+		pso.AddTexture(0, "uImage0");
+		pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
 
+		psosInitialized[variant] = pso.BeginCompile();
+		return psosInitialized[variant];
 	}
 
 
 	template <typename TPresentSurface, typename TRasterizer>
 	auto FontRenderer<TPresentSurface, TRasterizer>::AccumulateDrawState(const Array<I32> codepoints, const FontRendererOptions& options) -> V
 	{
+		if (!Init())
+		{
+			return;
+		}
+
 		auto uHeight = PresentSurface::UnitsToPixels(options.height);
-		auto atlasIdx = options.fontIndex | (uHeight << 16);
+		auto ar = PresentSurface::GetAspectRatio();
+		auto unitsPerPixel = PresentSurface::PixelsToUnits(1);
+		auto glyphTable = Rasterizer::GetGlyphTable(options.fontIndex, uHeight);
+
+		auto penX = options.offsetX;
+		auto baseline = options.offestY + Rasterizer::GetRasterizedFont(options.fontIndex).ascent * uHeight * unitsPerPixel;
+
+		// Consecutive glyphs almost always share a page, the batch state is
+		// only looked up again when it changes.
+		auto currentPage = AtlasGlyphDesc::CNoPage;
+		auto pageDrawable = false;
+		Buffers* buffersPtr = nullptr;
+		auto glyphScale = unitsPerPixel;
+
+		for (auto codepoint : codepoints)
+		{
+			auto glyphDescPtr = glyphTable? glyphTable->Find(codepoint) : nullptr;
+			if (!glyphDescPtr)
+			{
+				glyphDescPtr = Rasterizer::GetGlyph(options.fontIndex, uHeight, codepoint);
+				if (!glyphDescPtr)
+				{
+					// No room in the cache this frame, keep the rest of the
+					// line in place.
+					penX += Rasterizer::GetAdvance(options.fontIndex, codepoint) * uHeight * unitsPerPixel;
+					continue;
+				}
+			}
+
+			auto& glyphDesc = *glyphDescPtr;
+			if (glyphDesc.page != currentPage && glyphDesc.page != AtlasGlyphDesc::CNoPage)
+			{
+				currentPage = glyphDesc.page;
+				buffersPtr = GetBuffers(currentPage);
+
+				auto isSDF = Rasterizer::IsSDFPage(currentPage);
+				pageDrawable = InitPso(isSDF? U32(EFontFeature::SDF) : 0);
+				// SDF glyphs are stored at the base height and scaled to the requested one.
+				glyphScale = isSDF? unitsPerPixel * uHeight / Rasterizer::CSDFBaseHeight : unitsPerPixel;
+			}
+
+			if (glyphDesc.page != AtlasGlyphDesc::CNoPage && pageDrawable)
+			{
+				instances++;
+				if (buffersPtr->uvsBufferCPU.size() >= buffersPtr->instanceCapacity)
+				{
+					ReallocateBuffers(currentPage, buffersPtr->instanceCapacity * 2);
+				}
+
+				auto left = -1.f + (penX + glyphDesc.xOffset0 * glyphScale) * 2.f;
+				auto right = -1.f + (penX + glyphDesc.xOffset1 * glyphScale) * 2.f;
+				auto top = 1.f - (baseline + glyphDesc.yOffset0 * glyphScale) * ar * 2.f;
+				auto bottom = 1.f - (baseline + glyphDesc.yOffset1 * glyphScale) * ar * 2.f;
+
+				buffersPtr->uvsBufferCPU.emplace_back(glyphDesc.u0, glyphDesc.v0, glyphDesc.u1, glyphDesc.v1);
+				buffersPtr->colorsBufferCPU.emplace_back(options.color);
+				buffersPtr->linearTransformsBufferCPU.emplace_back((right - left) * 0.5f, 0.f, 0.f, (top - bottom) * 0.5f);
+				buffersPtr->translationsBufferCPU.emplace_back((left + right) * 0.5f, (top + bottom) * 0.5f);
+			}
 
+			penX += glyphDesc.xAdvance * (glyphDesc.page == currentPage? glyphScale : unitsPerPixel);
+		}
+	}
 
-		WL_ASSERT(atlasIdxToBuffers.find(atlasIdx) != atlasIdxToBuffers.end());
-		auto buffersPtr = atlasIdxToBuffers[atlasIdx];
-		usedAtlases.insert(atlasIdx);
 
-		instances++;
-		if (instances > instanceCapacity)
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRenderer<TPresentSurface, TRasterizer>::AccumulateGlyphRun(GlyphRun& run, const FontRendererOptions& options) -> V
+	{
+		if (!Init())
 		{
-			ReallocateBuffers(atlasIdx, instanceCapacity * 2);
-			instanceCapacity *= 2;
+			return;
 		}
 
-		auto& rasterizedFont = Rasterizer::GetRasterizedFont(atlasIdx);
-		buffersPtr->atlas = rasterizedFont.heightToAtlas[uHeight];
+		auto ar = PresentSurface::GetAspectRatio();
+		auto unitsPerPixel = PresentSurface::PixelsToUnits(1);
 
-		F32 xAdvance = 0.f;
-		for (auto codepoint : codepoints)
+		if (run.options.subpixelPositioning)
+		{
+			auto originX = options.offsetX / unitsPerPixel;
+			auto originY = options.offestY / unitsPerPixel;
+			originX -= Floor(originX);
+			originY -= Floor(originY);
+
+			if (originX != run.quadsOriginX || originY != run.quadsOriginY)
+			{
+				run.quadsOriginX = originX;
+				run.quadsOriginY = originY;
+				run.quadsGeneration = ~0ull;
+			}
+		}
+
+		if (run.quadsGeneration != Rasterizer::GetGeneration())
+		{
+			ResolveQuads(run);
+		}
+
+		auto scaleX = unitsPerPixel * 2.f;
+		auto scaleY = unitsPerPixel * ar * 2.f;
+		auto originX = -1.f + options.offsetX * 2.f;
+		auto originY = 1.f - options.offestY * ar * 2.f;
+
+		auto currentPage = AtlasGlyphDesc::CNoPage;
+		auto isCachePage = false;
+		auto pageDrawable = false;
+		Buffers* buffersPtr = nullptr;
+
+		for (auto& quad : run.quads)
 		{
-			auto& glyphDesc = rasterizedFont.codePointAndHeightToGlyph[U32(codepoint) | (U64(uHeight) << 32)];
-			auto ar = PresentSurface::GetAspectRatio();
-
-			F32 x0 = PresentSurface::PixelsToUnits(glyphDesc.xOffset0);
-			F32 y0 = PresentSurface::PixelsToUnits(glyphDesc.yOffset0) * ar;
-			F32 x1 = PresentSurface::PixelsToUnits(glyphDesc.xOffset1);
-			F32 y1 = PresentSurface::PixelsToUnits(glyphDesc.yOffset1) * ar;
-			F32 width = x1 - x0;
-			F32 height = y1 - y0;
-			buffersPtr->uvsBufferCPU.emplace_back(glyphDesc.u0, glyphDesc.v0, glyphDesc.u1, glyphDesc.v1);
+			if (quad.page != currentPage)
+			{
+				currentPage = quad.page;
+				buffersPtr = GetBuffers(currentPage);
+				isCachePage = Rasterizer::IsCachePage(currentPage);
+				pageDrawable = InitPso(Rasterizer::IsSDFPage(currentPage)? U32(EFontFeature::SDF) : 0);
+			}
+
+			if (!pageDrawable)
+			{
+				continue;
+			}
+
+			// Keep the cached glyphs from being evicted while they are in use.
+			if (isCachePage)
+			{
+				Rasterizer::TouchGlyph(run.options.fontIndex, run.options.fontHeight, quad.codePoint, quad.phase);
+			}
+
+			instances++;
+			if (buffersPtr->uvsBufferCPU.size() >= buffersPtr->instanceCapacity)
+			{
+				ReallocateBuffers(currentPage, buffersPtr->instanceCapacity * 2);
+			}
+
+			auto left = originX + quad.rect[0] * scaleX;
+			auto top = originY - quad.rect[1] * scaleY;
+			auto right = originX + quad.rect[2] * scaleX;
+			auto bottom = originY - quad.rect[3] * scaleY;
+
+			buffersPtr->uvsBufferCPU.emplace_back(quad.uvs);
 			buffersPtr->colorsBufferCPU.emplace_back(options.color);
-			buffersPtr->linearTransformsBufferCPU.emplace_back(width, 0.f, 0.f, height);
-			buffersPtr->translationsBufferCPU.emplace_back(options.offsetX + x0 * 2.f + xAdvance, options.offestY + x0 * 2.f);
-			xAdvance += x0 * 2 + glyphDesc.xAdvance;
+			buffersPtr->linearTransformsBufferCPU.emplace_back((right - left) * 0.5f, 0.f, 0.f, (top - bottom) * 0.5f);
+			buffersPtr->translationsBufferCPU.emplace_back((left + right) * 0.5f, (top + bottom) * 0.5f);
+		}
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRenderer<TPresentSurface, TRasterizer>::ResolveQuads(GlyphRun& run) -> V
+	{
+		auto fontIndex = run.options.fontIndex;
+		auto fontHeight = run.options.fontHeight;
+		auto glyphTable = Rasterizer::GetGlyphTable(fontIndex, fontHeight);
+		auto complete = true;
+
+		run.quads.clear();
+		for (auto& glyph : run.glyphs)
+		{
+			auto x = glyph.x;
+			auto y = glyph.y;
+			auto phase = 0u;
+
+			auto glyphDescPtr = glyphTable? glyphTable->Find(glyph.codePoint) : nullptr;
+			auto isSDF = glyphDescPtr && glyphDescPtr->page != AtlasGlyphDesc::CNoPage && Rasterizer::IsSDFPage(glyphDescPtr->page);
+
+			// Distance fields are sampled exactly at any offset, coverage
+			// glyphs are swapped for the variant rasterized at the pen phase.
+			if (run.options.subpixelPositioning && !isSDF)
+			{
+				auto penX = run.quadsOriginX + glyph.x;
+				auto pixelX = Floor(penX);
+				phase = U32((penX - pixelX) * Rasterizer::CSubpixelPhases + 0.5f);
+				if (phase == Rasterizer::CSubpixelPhases)
+				{
+					phase = 0;
+					pixelX += 1.f;
+				}
+
+				x = pixelX - run.quadsOriginX;
+				y = Round(run.quadsOriginY + glyph.y) - run.quadsOriginY;
+
+				glyphDescPtr = Rasterizer::GetSubpixelGlyph(fontIndex, fontHeight, glyph.codePoint, phase);
+				if (!glyphDescPtr)
+				{
+					complete = false;
+					continue;
+				}
+			}
+			else if (!glyphDescPtr)
+			{
+				glyphDescPtr = Rasterizer::GetGlyph(fontIndex, fontHeight, glyph.codePoint);
+				if (!glyphDescPtr)
+				{
+					complete = false;
+					continue;
+				}
+			}
+
+			auto& glyphDesc = *glyphDescPtr;
+			if (glyphDesc.page == AtlasGlyphDesc::CNoPage)
+			{
+				continue;
+			}
+
+			auto scale = Rasterizer::IsSDFPage(glyphDesc.page)? F32(fontHeight) / Rasterizer::CSDFBaseHeight : 1.f;
+			run.quads.push_back(
+				{
+					.page = glyphDesc.page,
+					.codePoint = glyph.codePoint,
+					.phase = phase,
+					.rect = Vec4(
+						x + glyphDesc.xOffset0 * scale,
+						y + glyphDesc.yOffset0 * scale,
+						x + glyphDesc.xOffset1 * scale,
+						y + glyphDesc.yOffset1 * scale
+					),
+					.uvs = Vec4(glyphDesc.u0, glyphDesc.v0, glyphDesc.u1, glyphDesc.v1)
+				}
+			);
 		}
+
+		// Glyphs the cache had no room for are retried in the next frame.
+		run.quadsGeneration = complete? Rasterizer::GetGeneration() : ~0ull;
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRenderer<TPresentSurface, TRasterizer>::GetBuffers(U32 page) -> Buffers*
+	{
+		if (pageToBuffers.find(page) == pageToBuffers.end())
+		{
+			AllocateBuffers(page);
+		}
+
+		auto buffersPtr = pageToBuffers[page];
+		buffersPtr->atlas = Rasterizer::GetPage(page);
+		usedPages.insert(page);
+		return buffersPtr;
 	}
 
 
@@ -170,26 +405,32 @@ namespace WL
 			return;
 		}
 
-		for (auto atlasIdx : usedAtlases)
+		for (auto page : usedPages)
 		{
-			auto buffersPtr = atlasIdxToBuffers[atlasIdx];
+			auto& pso = psos[Rasterizer::IsSDFPage(page)? U32(EFontFeature::SDF) : 0];
+			if (!pso.IsReady())
+			{
+				continue;
+			}
+
+			auto buffersPtr = pageToBuffers[page];
 
 			buffersPtr->uvsBuffer.Update(buffersPtr->uvsBufferCPU);
 			buffersPtr->colorsBuffer.Update(buffersPtr->colorsBufferCPU);
 			buffersPtr->linearTransformsBuffer.Update(buffersPtr->linearTransformsBufferCPU);
 			buffersPtr->translationsBuffer.Update(buffersPtr->translationsBufferCPU);
 
+			pso.Use();
 			pso.BindVB(0, buffersPtr->linearTransformsBuffer, true);
 			pso.BindVB(1, buffersPtr->translationsBuffer, true);
 			pso.BindVB(2, buffersPtr->uvsBuffer, true);
 			pso.BindVB(3, buffersPtr->colorsBuffer, true);
-
-			pso.Use();
 			pso.BindTexture(*buffersPtr->atlas);
 
-			pso.DrawInstanced(0, DefaultQuad2D::verticesCount, instances);
+			pso.DrawInstanced(0, DefaultQuad2D::verticesCount, buffersPtr->uvsBufferCPU.size());
 		}
 
+		Rasterizer::NextFrame();
 		Clear();
 	}
 
@@ -199,22 +440,22 @@ namespace WL
 	{
 		instances = 0;
 
-		for (auto atlasIdx : usedAtlases)
+		for (auto page : usedPages)
 		{
-			auto buffersPtr = atlasIdxToBuffers[atlasIdx];
+			auto buffersPtr = pageToBuffers[page];
 			buffersPtr->linearTransformsBufferCPU.clear();
 			buffersPtr->translationsBufferCPU.clear();
 			buffersPtr->uvsBufferCPU.clear();
 			buffersPtr->colorsBufferCPU.clear();
 		}
 
-		usedAtlases.clear();
+		usedPages.clear();
 	}
 
 	template <typename TPresentSurface, typename TRasterizer>
-	inline auto FontRenderer<TPresentSurface, TRasterizer>::AllocateBuffers(U32 atlasIdx) -> B
+	inline auto FontRenderer<TPresentSurface, TRasterizer>::AllocateBuffers(U32 page) -> B
 	{
-		auto& buffersPtrRef = atlasIdxToBuffers[atlasIdx];
+		auto& buffersPtrRef = pageToBuffers[page];
 		buffersPtrRef = new Buffers;
 		B status =
 			buffersPtrRef->linearTransformsBuffer.Allocate(initialGlyphInstancesCapacity, false) &&
@@ -226,9 +467,10 @@ namespace WL
 
 
 	template <typename TPresentSurface, typename TRasterizer>
-	inline auto FontRenderer<TPresentSurface, TRasterizer>::ReallocateBuffers(U32 atlasIdx, U32 newCapacity) -> B
+	inline auto FontRenderer<TPresentSurface, TRasterizer>::ReallocateBuffers(U32 page, U32 newCapacity) -> B
 	{
-		auto buffersPtr = atlasIdxToBuffers[atlasIdx];
+		auto buffersPtr = pageToBuffers[page];
+		buffersPtr->instanceCapacity = newCapacity;
 		B status =
 			buffersPtr->linearTransformsBuffer.Reallocate(newCapacity, false) &&
 			buffersPtr->translationsBuffer.Reallocate(newCapacity, false) &&
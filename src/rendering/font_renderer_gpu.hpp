@@ -0,0 +1,278 @@
+// MIT License
+// 
+// Copyright (c) 2023 - 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <common/types.hpp>
+
+#include <algebra/algebra.hpp>
+
+#include <rendering/color.hpp>
+#include <rendering/font_renderer.hpp>
+#include <rendering/text_layout.hpp>
+
+#include <shaders/common.hpp>
+
+#include <gpu_api/shader.hpp>
+#include <gpu_api/pso.hpp>
+
+namespace WL
+{
+	// Draws text from the glyph outlines of FontRasterizerGPU. The offset in
+	// the options is the top left corner of the line and the height is the
+	// line height in units. Takes the place of FontRenderer in a renderer set,
+	// glyph runs are drawn at any size from the same outlines.
+	template <typename TPresentSurface, typename TRasterizer>
+	class FontRendererGPU
+	{
+	public:
+		using Rasterizer = TRasterizer;
+		using PresentSurface = TPresentSurface;
+		using GPUAPI = PresentSurface::GPUAPI;
+		using Buffer = GPUAPI::Buffer;
+		using Pso = GPUAPI::Pso;
+
+		static auto Init() -> B;
+		static auto AccumulateDrawState(const Array<I32> codepoints, const FontRendererOptions& options) -> V;
+		// Draws a laid out run at the offset of the options, the font and
+		// height are the ones the run was laid out with.
+		static auto AccumulateGlyphRun(GlyphRun& run, const FontRendererOptions& options) -> V;
+		static auto CommitDrawCommands() -> V;
+		static auto Clear() -> V;
+
+		static constexpr U32 initialGlyphInstancesCapacity = 1024;
+
+	private:
+		// Pen position and height in units.
+		static auto AccumulateGlyph(const OutlineGlyphDesc& glyph, F32 penX, F32 baseline, F32 height, ColorU32 color) -> V;
+		static auto AllocateBuffers() -> B;
+		static auto ReallocateBuffers(U32 newCapacity) -> B;
+
+		inline static U32 instanceCapacity = initialGlyphInstancesCapacity;
+		inline static U32 instances = 0;
+		inline static B initialized = false;
+
+		inline static Pso pso;
+		inline static Buffer rectsBuffer;
+		inline static Buffer glyphBoxesBuffer;
+		inline static Buffer bandsOffsetsBuffer;
+		inline static Buffer colorsBuffer;
+
+		inline static Array<Vec4> rectsBufferCPU;
+		inline static Array<Vec4> glyphBoxesBufferCPU;
+		inline static Array<U32> bandsOffsetsBufferCPU;
+		inline static Array<ColorU32> colorsBufferCPU;
+	};
+}
+
+
+namespace WL
+{
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRendererGPU<TPresentSurface, TRasterizer>::Init() -> B
+	{
+		if (initialized)
+		{
+			return true;
+		}
+
+		if (!AllocateBuffers())
+		{
+			return false;
+		}
+
+		auto& vert = SpecializeShader(FontOutlineTextVert);
+		auto& frag = SpecializeShader(FontOutlineTextFrag);
+		pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
+
+		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
+		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
+		pso.AddVBLayout({ .binding = 2, .type = EType::Uint, .components = 1 });
+		pso.AddVBLayout({ .binding = 3, .type = EType::Uint, .components = 1 });
+
+		pso.AddTexture(0, "uCurves");
+		pso.AddTexture(1, "uBands");
+		pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
+
+		initialized = pso.BeginCompile();
+		return initialized;
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRendererGPU<TPresentSurface, TRasterizer>::AccumulateDrawState(const Array<I32> codepoints, const FontRendererOptions& options) -> V
+	{
+		if (!Init())
+		{
+			return;
+		}
+
+		auto& font = Rasterizer::GetOutlineFont(options.fontIndex);
+		auto height = options.height;
+
+		auto penX = options.offsetX;
+		auto baseline = options.offestY + font.ascent * height;
+
+		for (auto codepoint : codepoints)
+		{
+			auto it = font.codePointToGlyph.find(codepoint);
+			if (it == font.codePointToGlyph.end())
+			{
+				continue;
+			}
+
+			AccumulateGlyph(it->second, penX, baseline, height, ColorU32(options.color));
+			penX += it->second.xAdvance * height;
+		}
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRendererGPU<TPresentSurface, TRasterizer>::AccumulateGlyphRun(GlyphRun& run, const FontRendererOptions& options) -> V
+	{
+		if (!Init())
+		{
+			return;
+		}
+
+		auto& font = Rasterizer::GetOutlineFont(run.options.fontIndex);
+		auto unitsPerPixel = PresentSurface::PixelsToUnits(1);
+		auto height = run.options.fontHeight * unitsPerPixel;
+
+		// The run is laid out in pixels, the outlines need no snapping.
+		for (auto& glyph : run.glyphs)
+		{
+			auto it = font.codePointToGlyph.find(glyph.codePoint);
+			if (it != font.codePointToGlyph.end())
+			{
+				AccumulateGlyph(it->second, options.offsetX + glyph.x * unitsPerPixel, options.offestY + glyph.y * unitsPerPixel, height, ColorU32(options.color));
+			}
+		}
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRendererGPU<TPresentSurface, TRasterizer>::AccumulateGlyph(const OutlineGlyphDesc& glyph, F32 penX, F32 baseline, F32 height, ColorU32 color) -> V
+	{
+		if (!glyph.curveCount)
+		{
+			return;
+		}
+
+		auto ar = PresentSurface::GetAspectRatio();
+		// Extend the quads by a pixel so the antialiased edges aren't cut.
+		auto pad = 1.f / Max(1.f, F32(PresentSurface::UnitsToPixels(height)));
+
+		instances++;
+		if (instances > instanceCapacity)
+		{
+			ReallocateBuffers(instanceCapacity * 2);
+			instanceCapacity *= 2;
+		}
+
+		auto x0 = glyph.x0 - pad;
+		auto y0 = glyph.y0 - pad;
+		auto x1 = glyph.x1 + pad;
+		auto y1 = glyph.y1 + pad;
+
+		auto left = penX + x0 * height;
+		auto right = penX + x1 * height;
+		auto bottom = baseline - y0 * height;
+		auto top = baseline - y1 * height;
+
+		rectsBufferCPU.emplace_back(-1.f + left * 2.f, 1.f - bottom * ar * 2.f, -1.f + right * 2.f, 1.f - top * ar * 2.f);
+		glyphBoxesBufferCPU.emplace_back(x0, y0, x1, y1);
+		bandsOffsetsBufferCPU.emplace_back(glyph.bandsOffset);
+		colorsBufferCPU.emplace_back(color);
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	auto FontRendererGPU<TPresentSurface, TRasterizer>::CommitDrawCommands() -> V
+	{
+		if (!instances)
+		{
+			return;
+		}
+
+		if (!pso.IsReady())
+		{
+			Clear();
+			return;
+		}
+
+		rectsBuffer.Update(rectsBufferCPU);
+		glyphBoxesBuffer.Update(glyphBoxesBufferCPU);
+		bandsOffsetsBuffer.Update(bandsOffsetsBufferCPU);
+		colorsBuffer.Update(colorsBufferCPU);
+
+		pso.Use();
+		pso.BindVB(0, rectsBuffer, true);
+		pso.BindVB(1, glyphBoxesBuffer, true);
+		pso.BindVB(2, bandsOffsetsBuffer, true);
+		pso.BindVB(3, colorsBuffer, true);
+
+		pso.BindTexture(*Rasterizer::GetCurveTexture(), 0);
+		pso.BindTexture(*Rasterizer::GetBandTexture(), 1);
+
+		pso.DrawInstanced(0, DefaultQuad2D::verticesCount, instances);
+
+		Clear();
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	inline auto FontRendererGPU<TPresentSurface, TRasterizer>::Clear() -> V
+	{
+		instances = 0;
+		rectsBufferCPU.clear();
+		glyphBoxesBufferCPU.clear();
+		bandsOffsetsBufferCPU.clear();
+		colorsBufferCPU.clear();
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	inline auto FontRendererGPU<TPresentSurface, TRasterizer>::AllocateBuffers() -> B
+	{
+		B status =
+			rectsBuffer.Allocate(initialGlyphInstancesCapacity, false) &&
+			glyphBoxesBuffer.Allocate(initialGlyphInstancesCapacity, false) &&
+			bandsOffsetsBuffer.Allocate(initialGlyphInstancesCapacity, false) &&
+			colorsBuffer.Allocate(initialGlyphInstancesCapacity, false);
+		return status;
+	}
+
+
+	template <typename TPresentSurface, typename TRasterizer>
+	inline auto FontRendererGPU<TPresentSurface, TRasterizer>::ReallocateBuffers(U32 newCapacity) -> B
+	{
+		B status =
+			rectsBuffer.Reallocate(newCapacity, false) &&
+			glyphBoxesBuffer.Reallocate(newCapacity, false) &&
+			bandsOffsetsBuffer.Reallocate(newCapacity, false) &&
+			colorsBuffer.Reallocate(newCapacity, false);
+		return status;
+	}
+}
@@ -27,6 +27,7 @@
 #include <algebra/vector.hpp>
 
 #include "color.hpp"
+#include "stroke.hpp"
 
 
 namespace WL
@@ -42,28 +43,45 @@ namespace WL
 		using Pso = GPUAPI::Pso;
 		using Line = Line<F32, 2>;
 
-		static auto Init() -> B;
+		static auto Init(U32 variant) -> B;
 		static auto AccumulateLine(const Line& curve, ColorU32 color, F32 width, F32 feather = 1.0f, F32 fBegin = feather, F32 fEnd = feather) -> V;
+		static auto AccumulateLine(const Line& line, const StrokeSegment& stroke) -> V;
 		static auto CommitDrawCommands() -> V;
 		static auto Clear() -> V;
 
 		static constexpr U32 initialLineInstancesCapacity = 1024;
 
 	private:
-		static auto AllocateBuffers() -> B;
-		static auto ReallocateBuffers(U32 newCapacity) -> B;
-
-		inline static U32 instanceCapacity = initialLineInstancesCapacity;
-		inline static U32 instances = 0;
-
-		inline static Pso pso;
-		inline static Buffer pointsBuffer;
-		inline static Buffer colorsBuffer;
-		inline static Buffer widthAndFeathersBuffer;
-
-		inline static Array<Vec4> pointsBufferCPU;
-		inline static Array<ColorU32> colorsBufferCPU;
-		inline static Array<Vec4> widthAndFeathersBufferCPU;
+		// Instances are bucketed by shader variant so hard lines don't pay
+		// for the feathering, see EStrokeFeature.
+		struct Batch
+		{
+			U32 instanceCapacity = initialLineInstancesCapacity;
+			U32 instances = 0;
+			B initialized = false;
+			B joined = false;
+
+			Pso pso;
+			Buffer pointsBuffer;
+			Buffer colorsBuffer;
+			Buffer widthAndFeathersBuffer;
+			Buffer neighboursBuffer;
+			Buffer flagsBuffer;
+
+			Array<Vec4> pointsBufferCPU;
+			Array<ColorU32> colorsBufferCPU;
+			Array<Vec4> widthAndFeathersBufferCPU;
+			Array<Vec4> neighboursBufferCPU;
+			Array<U32> flagsBufferCPU;
+		};
+
+		// Returns nullptr when the variant can't be initialized.
+		static auto AddInstance(U32 variant) -> Batch*;
+
+		static auto AllocateBuffers(Batch& batch) -> B;
+		static auto ReallocateBuffers(Batch& batch, U32 newCapacity) -> B;
+
+		inline static StaticArray<Batch, CLineVariants> batches;
 	};
 }
 
@@ -71,84 +89,168 @@ namespace WL
 namespace WL
 {
 	template<typename TPresentSurface>
-	inline auto LineRenderer<TPresentSurface>::Init() -> B
+	inline auto LineRenderer<TPresentSurface>::Init(U32 variant) -> B
 	{
-		if (!AllocateBuffers())
+		auto& batch = batches[variant];
+		if (batch.initialized)
+		{
+			return true;
+		}
+		batch.joined = variant & U32(EStrokeFeature::Joined);
+
+		if (!AllocateBuffers(batch))
 		{
 			return false;
 		}
 
-		pso.AddShader(LineVert.data(), LineVert.size(), EShaderType::Vertex);
-		pso.AddShader(LineFrag.data(), LineFrag.size(), EShaderType::Fragment);
+		auto& vert = SpecializeShader(LineVert, variant, CStrokeFeatureNames);
+		auto& frag = SpecializeShader(LineFrag, variant, CStrokeFeatureNames);
+		batch.pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		batch.pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
 
-		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
-		pso.AddVBLayout({ .binding = 1, .type = EType::Uint, .components = 1 });
-		pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 4 });
-		pso.AddSimpleConstant(0, EType::Float, "uScreenDims");
+		batch.pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
+		batch.pso.AddVBLayout({ .binding = 1, .type = EType::Uint, .components = 1 });
+		batch.pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 4 });
+		if (batch.joined)
+		{
+			batch.pso.AddVBLayout({ .binding = 3, .type = EType::Float, .components = 4 });
+			batch.pso.AddVBLayout({ .binding = 4, .type = EType::Uint, .components = 1 });
+		}
+		batch.pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
 
-		return pso.Compile();
+		batch.initialized = batch.pso.BeginCompile();
+		return batch.initialized;
 	}
 
 
 	template<typename TPresentSurface>
 	inline auto LineRenderer<TPresentSurface>::AccumulateLine(const Line& line, ColorU32 color, F32 width, F32 feather, F32 fBegin, F32 fEnd) -> V
 	{
-		instances++;
-		if (instances > instanceCapacity)
+		auto feathered = feather > 0.f || fBegin > 0.f || fEnd > 0.f;
+		auto variant = feathered? U32(EStrokeFeature::Feathered) : 0u;
+		auto batchPtr = AddInstance(variant);
+		if (!batchPtr)
 		{
-			ReallocateBuffers(instanceCapacity * 2);
-			instanceCapacity *= 2;
+			return;
 		}
+		auto& batch = *batchPtr;
 
-		pointsBufferCPU.emplace_back(line.p0[0], line.p0[1], line.p1[0], line.p1[1]);
-		colorsBufferCPU.emplace_back(color);
-		widthAndFeathersBufferCPU.emplace_back(width, feather, fBegin, fEnd);
+		batch.pointsBufferCPU.emplace_back(line.p0[0], line.p0[1], line.p1[0], line.p1[1]);
+		batch.colorsBufferCPU.emplace_back(color);
+		batch.widthAndFeathersBufferCPU.emplace_back(width, feather, fBegin, fEnd);
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto LineRenderer<TPresentSurface>::CommitDrawCommands() -> V
+	inline auto LineRenderer<TPresentSurface>::AccumulateLine(const Line& line, const StrokeSegment& stroke) -> V
 	{
-		if (!instances)
+		auto variant = U32(EStrokeFeature::Joined);
+		if (stroke.feather > 0.f)
+		{
+			variant |= U32(EStrokeFeature::Feathered);
+		}
+		auto batchPtr = AddInstance(variant);
+		if (!batchPtr)
 		{
 			return;
 		}
+		auto& batch = *batchPtr;
 
-		pointsBuffer.Update(pointsBufferCPU);
-		colorsBuffer.Update(colorsBufferCPU);
-		widthAndFeathersBuffer.Update(widthAndFeathersBufferCPU);
+		batch.pointsBufferCPU.emplace_back(line.p0[0], line.p0[1], line.p1[0], line.p1[1]);
+		batch.colorsBufferCPU.emplace_back(stroke.color);
+		batch.widthAndFeathersBufferCPU.emplace_back(stroke.widthBegin, stroke.feather, stroke.widthEnd, stroke.miterLimit);
+		batch.neighboursBufferCPU.emplace_back(stroke.previous[0], stroke.previous[1], stroke.next[0], stroke.next[1]);
+		batch.flagsBufferCPU.emplace_back(stroke.GetFlags());
+	}
 
-		pso.Use();
-		pso.BindVB(0, pointsBuffer, true);
-		pso.BindVB(1, colorsBuffer, true);
-		pso.BindVB(2, widthAndFeathersBuffer, true);
 
-		pso.UpdateConstant(0, PresentSurface::GetDimensions());
+	template<typename TPresentSurface>
+	inline auto LineRenderer<TPresentSurface>::AddInstance(U32 variant) -> Batch*
+	{
+		auto& batch = batches[variant];
+		if (!Init(variant))
+		{
+			return nullptr;
+		}
+
+		batch.instances++;
+		if (batch.instances > batch.instanceCapacity)
+		{
+			ReallocateBuffers(batch, batch.instanceCapacity * 2);
+			batch.instanceCapacity *= 2;
+		}
+
+		return &batch;
+	}
 
-		pso.DrawInstanced(0, 6, instances);
+
+	template<typename TPresentSurface>
+	inline auto LineRenderer<TPresentSurface>::CommitDrawCommands() -> V
+	{
+		for (auto& batch : batches)
+		{
+			if (!batch.instances || !batch.pso.IsReady())
+			{
+				continue;
+			}
+
+			batch.pointsBuffer.Update(batch.pointsBufferCPU);
+			batch.colorsBuffer.Update(batch.colorsBufferCPU);
+			batch.widthAndFeathersBuffer.Update(batch.widthAndFeathersBufferCPU);
+			if (batch.joined)
+			{
+				batch.neighboursBuffer.Update(batch.neighboursBufferCPU);
+				batch.flagsBuffer.Update(batch.flagsBufferCPU);
+			}
+
+			batch.pso.Use();
+			batch.pso.BindVB(0, batch.pointsBuffer, true);
+			batch.pso.BindVB(1, batch.colorsBuffer, true);
+			batch.pso.BindVB(2, batch.widthAndFeathersBuffer, true);
+			if (batch.joined)
+			{
+				batch.pso.BindVB(3, batch.neighboursBuffer, true);
+				batch.pso.BindVB(4, batch.flagsBuffer, true);
+			}
+
+
+			batch.pso.DrawInstanced(0, 6, batch.instances);
+		}
 
 		Clear();
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto LineRenderer<TPresentSurface>::AllocateBuffers() -> B
+	inline auto LineRenderer<TPresentSurface>::AllocateBuffers(Batch& batch) -> B
 	{
 		B status =
-			pointsBuffer.Allocate(initialLineInstancesCapacity, false) &&
-			colorsBuffer.Allocate(initialLineInstancesCapacity, false) &&
-			widthAndFeathersBuffer.Allocate(initialLineInstancesCapacity, false);
+			batch.pointsBuffer.Allocate(initialLineInstancesCapacity, false) &&
+			batch.colorsBuffer.Allocate(initialLineInstancesCapacity, false) &&
+			batch.widthAndFeathersBuffer.Allocate(initialLineInstancesCapacity, false);
+		if (batch.joined)
+		{
+			status = status &&
+				batch.neighboursBuffer.Allocate(initialLineInstancesCapacity, false) &&
+				batch.flagsBuffer.Allocate(initialLineInstancesCapacity, false);
+		}
 		return status;
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto LineRenderer<TPresentSurface>::ReallocateBuffers(U32 newCapacity) -> B
+	inline auto LineRenderer<TPresentSurface>::ReallocateBuffers(Batch& batch, U32 newCapacity) -> B
 	{
 		B status =
-			pointsBuffer.Reallocate(newCapacity, false) &&
-			colorsBuffer.Reallocate(newCapacity, false) &&
-			widthAndFeathersBuffer.Reallocate(newCapacity, false);
+			batch.pointsBuffer.Reallocate(newCapacity, false) &&
+			batch.colorsBuffer.Reallocate(newCapacity, false) &&
+			batch.widthAndFeathersBuffer.Reallocate(newCapacity, false);
+		if (batch.joined)
+		{
+			status = status &&
+				batch.neighboursBuffer.Reallocate(newCapacity, false) &&
+				batch.flagsBuffer.Reallocate(newCapacity, false);
+		}
 		return status;
 	}
 
@@ -156,9 +258,14 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto LineRenderer<TPresentSurface>::Clear() -> V
 	{
-		instances = 0;
-		pointsBufferCPU.clear();
-		colorsBufferCPU.clear();
-		widthAndFeathersBufferCPU.clear();
+		for (auto& batch : batches)
+		{
+			batch.instances = 0;
+			batch.pointsBufferCPU.clear();
+			batch.colorsBufferCPU.clear();
+			batch.widthAndFeathersBufferCPU.clear();
+			batch.neighboursBufferCPU.clear();
+			batch.flagsBufferCPU.clear();
+		}
 	}
 }
\ No newline at end of file
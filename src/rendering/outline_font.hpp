@@ -0,0 +1,56 @@
+// MIT License
+// 
+// Copyright (c) 2023 - 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <common/types.hpp>
+
+
+namespace WL
+{
+	struct OutlineGlyphDesc
+	{
+		// Bounding box of the outline in font space normalized by the line
+		// height, y points up.
+		F32 x0;
+		F32 y0;
+		F32 x1;
+		F32 y1;
+		F32 xAdvance;
+		// Texel index of the band header in the band texture.
+		U32 bandsOffset;
+		U32 curveCount;
+	};
+
+	struct OutlineFont
+	{
+		F32 ascent;
+		F32 descent;
+		F32 lineGap;
+
+		Map<U32, OutlineGlyphDesc> codePointToGlyph;
+		// Keyed by the codepoints of the pair, memoized from stb_truetype.
+		Map<U64, F32> kerningPairs;
+		B hasKerning = false;
+	};
+}
@@ -0,0 +1,365 @@
+// MIT License
+// 
+// Copyright (c) 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <common/types.hpp>
+#include <common/utilities.hpp>
+
+#include <algebra/algebra.hpp>
+#include <algebra/bezier.hpp>
+
+#include <rendering/color.hpp>
+#include <rendering/quad.hpp>
+
+#include <shaders/common.hpp>
+
+#include <gpu_api/shader.hpp>
+#include <gpu_api/pso.hpp>
+
+namespace WL
+{
+	// Closed outline prepared for PathFillRenderer, built once and drawn
+	// every frame. Uses the layout of the FontRasterizerGPU textures with
+	// all indices relative to the fill.
+	//
+	// Curve texels: two per curve, (p0, p1) and (p2, 0).
+	// Band texels: a header (band count, min y, 1 / band height, 0), a texel
+	// per horizontal band (first list texel, curve count, 0, 0) and the
+	// lists of curve texel indices packed four per texel.
+	struct PathFill
+	{
+		Vec4 bounds = Vec4(0.f, 0.f, 0.f, 0.f);
+		Array<Vec4> curveTexels;
+		Array<UVec4> bandTexels;
+	};
+
+	// Fills paths on the GPU with the nonzero rule. Every fragment of the
+	// path bounds sums the crossings of a horizontal ray with the curves of
+	// its band, as FontRendererGPU does for glyphs, so nothing is rasterized
+	// on the CPU and fills stay sharp at any scale.
+	template <typename TPresentSurface>
+	class PathFillRenderer
+	{
+	public:
+		using PresentSurface = TPresentSurface;
+		using GPUAPI = PresentSurface::GPUAPI;
+		using Buffer = GPUAPI::Buffer;
+		using Image = GPUAPI::Image;
+		using Pso = GPUAPI::Pso;
+		using QuadraticBezier = QuadraticBezier<F32, 2>;
+
+		// Texels per row of both textures, must match the fill shader.
+		static constexpr U32 CTextureWidth = 1024;
+		static constexpr U32 CMaxBandCount = 32;
+		static constexpr U32 CCurvesPerBand = 8;
+
+		static auto Init() -> B;
+		// Curves in WL coordinates, the contours have to be closed.
+		static auto BuildFill(Span<const QuadraticBezier> curves) -> PathFill;
+		static auto AccumulateFill(const PathFill& fill, ColorU32 color) -> V;
+		static auto CommitDrawCommands() -> V;
+		static auto Clear() -> V;
+
+		static constexpr U32 initialFillInstancesCapacity = 256;
+
+	private:
+		static auto AllocateBuffers() -> B;
+		static auto ReallocateBuffers(U32 newCapacity) -> B;
+		template <typename TTexel>
+		static auto UploadTexels(Image*& texture, EFormat format, Array<TTexel>& texels) -> V;
+
+		inline static U32 instanceCapacity = initialFillInstancesCapacity;
+		inline static U32 instances = 0;
+		inline static B initialized = false;
+
+		inline static Pso pso;
+		inline static Buffer rectsBuffer;
+		inline static Buffer boundsBuffer;
+		inline static Buffer curvesOffsetsBuffer;
+		inline static Buffer bandsOffsetsBuffer;
+		inline static Buffer colorsBuffer;
+
+		inline static Array<Vec4> rectsBufferCPU;
+		inline static Array<Vec4> boundsBufferCPU;
+		inline static Array<U32> curvesOffsetsBufferCPU;
+		inline static Array<U32> bandsOffsetsBufferCPU;
+		inline static Array<ColorU32> colorsBufferCPU;
+
+		// Texels of the fills drawn this frame.
+		inline static Array<Vec4> curveTexels;
+		inline static Array<UVec4> bandTexels;
+		inline static Image* curveTexture = nullptr;
+		inline static Image* bandTexture = nullptr;
+	};
+}
+
+
+namespace WL
+{
+	template <typename TPresentSurface>
+	auto PathFillRenderer<TPresentSurface>::Init() -> B
+	{
+		if (initialized)
+		{
+			return true;
+		}
+
+		if (!AllocateBuffers())
+		{
+			return false;
+		}
+
+		auto& vert = SpecializeShader(PathFillVert);
+		auto& frag = SpecializeShader(PathFillFrag);
+		pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
+
+		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
+		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 4 });
+		pso.AddVBLayout({ .binding = 2, .type = EType::Uint, .components = 1 });
+		pso.AddVBLayout({ .binding = 3, .type = EType::Uint, .components = 1 });
+		pso.AddVBLayout({ .binding = 4, .type = EType::Uint, .components = 1 });
+
+		pso.AddTexture(0, "uCurves");
+		pso.AddTexture(1, "uBands");
+		pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
+
+		initialized = pso.BeginCompile();
+		return initialized;
+	}
+
+
+	template <typename TPresentSurface>
+	auto PathFillRenderer<TPresentSurface>::BuildFill(Span<const QuadraticBezier> curves) -> PathFill
+	{
+		PathFill fill;
+		if (curves.empty())
+		{
+			return fill;
+		}
+
+		auto x0 = 1e30f;
+		auto y0 = 1e30f;
+		auto x1 = -1e30f;
+		auto y1 = -1e30f;
+		for (auto& curve : curves)
+		{
+			for (auto& point : curve.points)
+			{
+				x0 = Min(x0, point[0]);
+				y0 = Min(y0, point[1]);
+				x1 = Max(x1, point[0]);
+				y1 = Max(y1, point[1]);
+			}
+
+			fill.curveTexels.emplace_back(curve.p0[0], curve.p0[1], curve.p1[0], curve.p1[1]);
+			fill.curveTexels.emplace_back(curve.p2[0], curve.p2[1], 0.f, 0.f);
+		}
+		fill.bounds = Vec4(x0, y0, x1, y1);
+
+		auto bandCount = Clamp(U32(curves.size()) / CCurvesPerBand, 1u, CMaxBandCount);
+		auto bandHeight = Max(y1 - y0, 1e-6f) / bandCount;
+		Array<Array<U32>> bands(bandCount);
+		for (auto i = 0u; i < curves.size(); ++i)
+		{
+			auto& curve = curves[i];
+			auto minY = Min(curve.p0[1], Min(curve.p1[1], curve.p2[1]));
+			auto maxY = Max(curve.p0[1], Max(curve.p1[1], curve.p2[1]));
+			auto firstBand = U32(Max(0.f, (minY - y0) / bandHeight));
+			auto lastBand = Min(bandCount - 1, U32(Max(0.f, (maxY - y0) / bandHeight)));
+
+			for (auto band = firstBand; band <= lastBand; ++band)
+			{
+				bands[band].push_back(2 * i);
+			}
+		}
+
+		fill.bandTexels.emplace_back(bandCount, BitCast<U32>(y0), BitCast<U32>(1.f / bandHeight), 0u);
+		fill.bandTexels.resize(1 + bandCount, UVec4(0u, 0u, 0u, 0u));
+
+		for (auto band = 0u; band < bandCount; ++band)
+		{
+			auto& curveIndices = bands[band];
+			fill.bandTexels[1 + band] = UVec4(U32(fill.bandTexels.size()), U32(curveIndices.size()), 0u, 0u);
+
+			for (auto i = 0u; i < curveIndices.size(); i += 4)
+			{
+				UVec4 packed(0u, 0u, 0u, 0u);
+				for (auto j = 0u; j < 4 && i + j < curveIndices.size(); ++j)
+				{
+					packed[j] = curveIndices[i + j];
+				}
+				fill.bandTexels.push_back(packed);
+			}
+		}
+
+		return fill;
+	}
+
+
+	template <typename TPresentSurface>
+	auto PathFillRenderer<TPresentSurface>::AccumulateFill(const PathFill& fill, ColorU32 color) -> V
+	{
+		if (fill.curveTexels.empty())
+		{
+			return;
+		}
+
+		if (!Init())
+		{
+			return;
+		}
+
+		instances++;
+		if (instances > instanceCapacity)
+		{
+			ReallocateBuffers(instanceCapacity * 2);
+			instanceCapacity *= 2;
+		}
+
+		// Extend the quads by a pixel so the antialiased edges aren't cut.
+		auto pad = PresentSurface::PixelsToUnits(1);
+		auto x0 = fill.bounds[0] - pad;
+		auto y0 = fill.bounds[1] - pad;
+		auto x1 = fill.bounds[2] + pad;
+		auto y1 = fill.bounds[3] + pad;
+
+		auto topLeft = PresentSurface::WLToRenderCoords(Vec2(x0, y0));
+		auto bottomRight = PresentSurface::WLToRenderCoords(Vec2(x1, y1));
+
+		rectsBufferCPU.emplace_back(topLeft[0], topLeft[1], bottomRight[0], bottomRight[1]);
+		boundsBufferCPU.emplace_back(x0, y0, x1, y1);
+		curvesOffsetsBufferCPU.emplace_back(U32(curveTexels.size()));
+		bandsOffsetsBufferCPU.emplace_back(U32(bandTexels.size()));
+		colorsBufferCPU.emplace_back(color);
+
+		curveTexels.insert(curveTexels.end(), fill.curveTexels.begin(), fill.curveTexels.end());
+		bandTexels.insert(bandTexels.end(), fill.bandTexels.begin(), fill.bandTexels.end());
+	}
+
+
+	template <typename TPresentSurface>
+	auto PathFillRenderer<TPresentSurface>::CommitDrawCommands() -> V
+	{
+		if (!instances)
+		{
+			return;
+		}
+
+		if (!pso.IsReady())
+		{
+			Clear();
+			return;
+		}
+
+		UploadTexels(curveTexture, EFormat::RGBA32Float, curveTexels);
+		UploadTexels(bandTexture, EFormat::RGBA32, bandTexels);
+
+		rectsBuffer.Update(rectsBufferCPU);
+		boundsBuffer.Update(boundsBufferCPU);
+		curvesOffsetsBuffer.Update(curvesOffsetsBufferCPU);
+		bandsOffsetsBuffer.Update(bandsOffsetsBufferCPU);
+		colorsBuffer.Update(colorsBufferCPU);
+
+		pso.Use();
+		pso.BindVB(0, rectsBuffer, true);
+		pso.BindVB(1, boundsBuffer, true);
+		pso.BindVB(2, curvesOffsetsBuffer, true);
+		pso.BindVB(3, bandsOffsetsBuffer, true);
+		pso.BindVB(4, colorsBuffer, true);
+
+		pso.BindTexture(*curveTexture, 0);
+		pso.BindTexture(*bandTexture, 1);
+
+		pso.DrawInstanced(0, DefaultQuad2D::verticesCount, instances);
+
+		Clear();
+	}
+
+
+	template <typename TPresentSurface>
+	template <typename TTexel>
+	auto PathFillRenderer<TPresentSurface>::UploadTexels(Image*& texture, EFormat format, Array<TTexel>& texels) -> V
+	{
+		static_assert(sizeof(TTexel) == 16);
+
+		// Pad the last row, the arrays are cleared after the commit anyway.
+		auto rows = Max(1u, U32(texels.size() + CTextureWidth - 1) / CTextureWidth);
+		texels.resize(rows * CTextureWidth);
+
+		// Storage only grows, smaller frames update the rows they use.
+		if (texture == nullptr)
+		{
+			texture = new Image;
+			texture->Allocate(format, CTextureWidth, rows, 1);
+			texture->InitData(nullptr);
+		}
+		else if (rows > texture->height)
+		{
+			texture->height = Max(rows, texture->height * 2);
+			texture->InitData(nullptr);
+		}
+		texture->UpdateData({ .x = 0, .y = 0, .z = 0, .w = CTextureWidth, .h = rows, .d = 1 }, texels.data());
+	}
+
+
+	template <typename TPresentSurface>
+	inline auto PathFillRenderer<TPresentSurface>::Clear() -> V
+	{
+		instances = 0;
+		rectsBufferCPU.clear();
+		boundsBufferCPU.clear();
+		curvesOffsetsBufferCPU.clear();
+		bandsOffsetsBufferCPU.clear();
+		colorsBufferCPU.clear();
+		curveTexels.clear();
+		bandTexels.clear();
+	}
+
+
+	template <typename TPresentSurface>
+	inline auto PathFillRenderer<TPresentSurface>::AllocateBuffers() -> B
+	{
+		B status =
+			rectsBuffer.Allocate(initialFillInstancesCapacity, false) &&
+			boundsBuffer.Allocate(initialFillInstancesCapacity, false) &&
+			curvesOffsetsBuffer.Allocate(initialFillInstancesCapacity, false) &&
+			bandsOffsetsBuffer.Allocate(initialFillInstancesCapacity, false) &&
+			colorsBuffer.Allocate(initialFillInstancesCapacity, false);
+		return status;
+	}
+
+
+	template <typename TPresentSurface>
+	inline auto PathFillRenderer<TPresentSurface>::ReallocateBuffers(U32 newCapacity) -> B
+	{
+		B status =
+			rectsBuffer.Reallocate(newCapacity, false) &&
+			boundsBuffer.Reallocate(newCapacity, false) &&
+			curvesOffsetsBuffer.Reallocate(newCapacity, false) &&
+			bandsOffsetsBuffer.Reallocate(newCapacity, false) &&
+			colorsBuffer.Reallocate(newCapacity, false);
+		return status;
+	}
+}
@@ -19,22 +19,301 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
+#pragma once
 
+#include <bit>
 
-#pragma once
+#include <common/types.hpp>
+#include <common/memory.hpp>
 
-#include "common/types.hpp"
-#include "rasterized_font.hpp"
+#include <algebra/arithmetic.hpp>
+
+#include <gpu_api/image.hpp>
 
 
 namespace WL
 {
-	template <typename GPUAPI>
+	// Cache of small A8 bitmaps packed into pages of equally sized slots.
+	// Each page serves one power of two slot size. When the pages fill up
+	// either the least recently used slot of the requested size is reused or
+	// the least recently used page of another size is cleared and takes the
+	// requested size, whichever was used longer ago.
+	template <typename TGPUAPI>
 	class RasterCache
 	{
+	public:
+		using GPUAPI = TGPUAPI;
+		using Image = GPUAPI::Image;
+
+		static constexpr U32 CDefaultPageSize = 1024;
+		static constexpr U32 CDefaultMaxPages = 4;
+		static constexpr U32 CMinSlotSize = 16;
+
+		struct Slot
+		{
+			U32 page;
+			U32 index;
+			U32 x;
+			U32 y;
+			U32 width;
+			U32 height;
+		};
+
+		RasterCache(U32 pageSize = CDefaultPageSize, U32 maxPages = CDefaultMaxPages);
+
+		// Returns the slot holding key and marks it as used, nullptr if it is
+		// not cached.
+		auto Find(U64 key) -> const Slot*;
+		// Uploads the bitmap into a free or evicted slot. Slots and pages
+		// used since the last NextFrame are never evicted, if nothing else is
+		// available nullptr is returned.
+		auto Insert(U64 key, const Byte* bitmap, U32 width, U32 height) -> const Slot*;
+		auto NextFrame() -> V;
+
+		auto GetPage(U32 page) const -> Image*;
+		auto GetPageCount() const -> U32;
+		auto GetPageSize() const -> U32;
+		// Slots handed out before may have been reused when this changes.
+		auto GetEvictionCount() const -> U64;
+
 	private:
-		Map<U32, U32> sizeToFont;
-		ChunkArray<RasterizedFont<GPUAPI>> fonts;
+		struct SlotState
+		{
+			U64 key = 0;
+			U64 lastUse = 0;
+			B occupied = false;
+		};
+
+		struct Page
+		{
+			Image* image;
+			U32 slotSize;
+			Array<SlotState> slots;
+			// Latest use of any of the slots.
+			U64 lastUse;
+		};
+
+		auto AllocatePage(U32 slotSize) -> B;
+		auto ReclaimPage(U32 page, U32 slotSize) -> V;
+		auto Place(U32 page, U32 index, U64 key, const Byte* bitmap, U32 width, U32 height) -> const Slot*;
+
+		U32 pageSize;
+		U32 maxPages;
+		U64 useTick = 1;
+		U64 frameStartTick = 1;
+		U64 evictionCount = 0;
+
+		Array<Page> pages;
+		Array<Byte> staging;
+		Map<U64, Slot> keyToSlot;
 	};
+}
+
+
+namespace WL
+{
+	template <typename TGPUAPI>
+	RasterCache<TGPUAPI>::RasterCache(U32 pageSize, U32 maxPages) :
+		pageSize(pageSize), maxPages(maxPages)
+	{
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::Find(U64 key) -> const Slot*
+	{
+		auto it = keyToSlot.find(key);
+		if (it == keyToSlot.end())
+		{
+			return nullptr;
+		}
+
+		auto& slot = it->second;
+		pages[slot.page].slots[slot.index].lastUse = useTick;
+		pages[slot.page].lastUse = useTick++;
+		return &slot;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::Insert(U64 key, const Byte* bitmap, U32 width, U32 height) -> const Slot*
+	{
+		auto slotSize = Max(CMinSlotSize, std::bit_ceil(Max(width, height)));
+		if (slotSize > pageSize)
+		{
+			return nullptr;
+		}
+
+		for (auto p = 0u; p < pages.size(); ++p)
+		{
+			if (pages[p].slotSize != slotSize)
+			{
+				continue;
+			}
+
+			for (auto i = 0u; i < pages[p].slots.size(); ++i)
+			{
+				if (!pages[p].slots[i].occupied)
+				{
+					return Place(p, i, key, bitmap, width, height);
+				}
+			}
+		}
+
+		if (pages.size() < maxPages && AllocatePage(slotSize))
+		{
+			return Place(pages.size() - 1, 0, key, bitmap, width, height);
+		}
+
+		auto lruPage = ~0u;
+		auto lruIndex = ~0u;
+		auto lruUse = frameStartTick;
+		auto reclaimPage = ~0u;
+		auto reclaimUse = frameStartTick;
+		for (auto p = 0u; p < pages.size(); ++p)
+		{
+			if (pages[p].slotSize != slotSize)
+			{
+				if (pages[p].lastUse < reclaimUse)
+				{
+					reclaimPage = p;
+					reclaimUse = pages[p].lastUse;
+				}
+				continue;
+			}
+
+			for (auto i = 0u; i < pages[p].slots.size(); ++i)
+			{
+				if (pages[p].slots[i].lastUse < lruUse)
+				{
+					lruPage = p;
+					lruIndex = i;
+					lruUse = pages[p].slots[i].lastUse;
+				}
+			}
+		}
+
+		if (reclaimPage != ~0u && (lruPage == ~0u || reclaimUse < lruUse))
+		{
+			ReclaimPage(reclaimPage, slotSize);
+			return Place(reclaimPage, 0, key, bitmap, width, height);
+		}
+
+		if (lruPage == ~0u)
+		{
+			return nullptr;
+		}
+
+		keyToSlot.erase(pages[lruPage].slots[lruIndex].key);
+		evictionCount++;
+		return Place(lruPage, lruIndex, key, bitmap, width, height);
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::NextFrame() -> V
+	{
+		frameStartTick = useTick;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::GetPage(U32 page) const -> Image*
+	{
+		return pages[page].image;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::GetPageCount() const -> U32
+	{
+		return pages.size();
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::GetPageSize() const -> U32
+	{
+		return pageSize;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::GetEvictionCount() const -> U64
+	{
+		return evictionCount;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::AllocatePage(U32 slotSize) -> B
+	{
+		auto image = new Image;
+		if (!image->Allocate(EFormat::A8, pageSize, pageSize, 1))
+		{
+			delete image;
+			return false;
+		}
+
+		Array<Byte> zeros(pageSize * pageSize, 0);
+		image->InitData(zeros.data());
+
+		auto slotsPerRow = pageSize / slotSize;
+		pages.push_back({ .image = image, .slotSize = slotSize, .slots = Array<SlotState>(slotsPerRow * slotsPerRow), .lastUse = 0 });
+		return true;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::ReclaimPage(U32 page, U32 slotSize) -> V
+	{
+		auto& pageRef = pages[page];
+		for (auto& slot : pageRef.slots)
+		{
+			if (slot.occupied)
+			{
+				keyToSlot.erase(slot.key);
+				evictionCount++;
+			}
+		}
+
+		// Slots are uploaded whole so the old texels never show through.
+		auto slotsPerRow = pageSize / slotSize;
+		pageRef.slotSize = slotSize;
+		pageRef.slots.assign(slotsPerRow * slotsPerRow, {});
+		pageRef.lastUse = 0;
+	}
+
+
+	template <typename TGPUAPI>
+	auto RasterCache<TGPUAPI>::Place(U32 page, U32 index, U64 key, const Byte* bitmap, U32 width, U32 height) -> const Slot*
+	{
+		auto& pageRef = pages[page];
+		auto slotSize = pageRef.slotSize;
+		auto slotsPerRow = pageSize / slotSize;
+
+		Slot slot =
+		{
+			.page = page,
+			.index = index,
+			.x = (index % slotsPerRow) * slotSize,
+			.y = (index / slotsPerRow) * slotSize,
+			.width = width,
+			.height = height
+		};
+
+		// The whole slot is uploaded, it clears what an evicted entry left
+		// behind and keeps the rows 4 byte aligned for the default unpack
+		// alignment.
+		staging.assign(slotSize * slotSize, 0);
+		for (auto y = 0u; y < height; ++y)
+		{
+			memcpy(staging.data() + y * slotSize, bitmap + y * width, width);
+		}
+		pageRef.image->UpdateData({ slot.x, slot.y, 0, slotSize, slotSize, 1 }, staging.data());
 
-}
\ No newline at end of file
+		pageRef.slots[index] = { .key = key, .lastUse = useTick, .occupied = true };
+		pageRef.lastUse = useTick++;
+		return &(keyToSlot[key] = slot);
+	}
+}
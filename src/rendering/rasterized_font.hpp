@@ -42,6 +42,34 @@ namespace WL
 		F32 xOffset1;
 		F32 yOffset1;
 		F32 xAdvance;
+		// Rasterizer page holding the glyph, CNoPage for glyphs without pixels
+		U32 page;
+
+		static constexpr U32 CNoPage = ~0u;
+	};
+
+	// Glyphs of one height. Contiguous codepoint runs are stored densely and
+	// found by their offset in the run, other codepoints go to a sparse map.
+	class GlyphTable
+	{
+	public:
+		inline auto Find(U32 codePoint) const -> const AtlasGlyphDesc*;
+		// Extends the last run when codePoint follows it, starts a new one
+		// otherwise. A run left with a single glyph moves to the sparse map.
+		inline auto Append(U32 codePoint, const AtlasGlyphDesc& glyphDesc) -> V;
+		inline auto Insert(U32 codePoint, const AtlasGlyphDesc& glyphDesc) -> V;
+
+	private:
+		struct Run
+		{
+			U32 firstChar;
+			U32 count;
+			U32 offset;
+		};
+
+		Array<Run> runs;
+		Array<AtlasGlyphDesc> glyphs;
+		Map<U32, AtlasGlyphDesc> sparseGlyphs;
 	};
 
 	template <typename TGPUAPI>
@@ -51,7 +79,82 @@ namespace WL
 		using GPUAPI = TGPUAPI;
 		using Image = GPUAPI::Image;
 
-		Map<U64, AtlasGlyphDesc> codePointAndHeightToGlyph;
-		Map<U16, Image*> heightToAtlas;
+		// Height key of the SDF atlas which serves all heights.
+		static constexpr U16 CSDFHeight = 0;
+
+		struct GlyphMetrics
+		{
+			I32 glyphIndex;
+			F32 xAdvance;
+		};
+
+		// Metrics of a font with pixel height 1.
+		F32 ascent = 0.f;
+		F32 descent = 0.f;
+		F32 lineGap = 0.f;
+		Map<U32, GlyphMetrics> codePointToMetrics;
+		// Keyed by the glyph indices of the pair, memoized from lookups that
+		// add the GPOS and kern table adjustments.
+		Map<U64, F32> kerningPairs;
+		B hasKerning = false;
+
+		Map<U16, GlyphTable> heightToGlyphs;
+		Map<U16, Array<Image*>> heightToAtlasPages;
 	};
+}
+
+
+namespace WL
+{
+	inline auto GlyphTable::Find(U32 codePoint) const -> const AtlasGlyphDesc*
+	{
+		for (auto& run : runs)
+		{
+			// Wraps around for codepoints below the run.
+			auto index = codePoint - run.firstChar;
+			if (index < run.count)
+			{
+				return &glyphs[run.offset + index];
+			}
+		}
+
+		auto it = sparseGlyphs.find(codePoint);
+		return it != sparseGlyphs.end()? &it->second : nullptr;
+	}
+
+
+	inline auto GlyphTable::Append(U32 codePoint, const AtlasGlyphDesc& glyphDesc) -> V
+	{
+		if (runs.empty() || runs.back().firstChar + runs.back().count != codePoint)
+		{
+			// Isolated glyphs would cost a run each in every Find.
+			if (!runs.empty() && runs.back().count == 1)
+			{
+				sparseGlyphs[runs.back().firstChar] = glyphs.back();
+				glyphs.pop_back();
+				runs.pop_back();
+			}
+
+			runs.push_back({ .firstChar = codePoint, .count = 0, .offset = U32(glyphs.size()) });
+		}
+
+		runs.back().count++;
+		glyphs.push_back(glyphDesc);
+	}
+
+
+	inline auto GlyphTable::Insert(U32 codePoint, const AtlasGlyphDesc& glyphDesc) -> V
+	{
+		for (auto& run : runs)
+		{
+			auto index = codePoint - run.firstChar;
+			if (index < run.count)
+			{
+				glyphs[run.offset + index] = glyphDesc;
+				return;
+			}
+		}
+
+		sparseGlyphs[codePoint] = glyphDesc;
+	}
 }
\ No newline at end of file
@@ -37,11 +37,26 @@ namespace WL
 		using LineRenderer = TRenderers::LineRenderer;
 		using ArcRenderer = TRenderers::ArcRenderer;
 		using VectorRasterizer = TRenderers::VectorRasterizer;
+		using VectorRasterCache = TRenderers::VectorRasterCache;
 		using BezierRenderer = TRenderers::BezierRenderer;
+		using PathFillRenderer = TRenderers::PathFillRenderer;
 
+		// Renderers initialize themselves on first use and only submit their
+		// programs for compilation, the status is checked before the first
+		// draw. This way only the used programs are compiled and the driver
+		// can compile them in parallel. A renderer that fails to initialize
+		// drops the draws and tries again on its next use. Init sets up the
+		// state shared by all programs and reports if that fails.
 		static auto Init() -> B;
-		static auto CommitDrawCommands() -> V;
-		static auto Clear() -> V;
+		// Draws a layer renderer by renderer in a fixed order, and every
+		// renderer draws its shader variants one after another. The order
+		// of draws within a layer is therefore not the submission order,
+		// overlapping blended draws that need it go on separate layers.
+		// When text is deferred font instances are kept across commits and
+		// drawn later with CommitDeferredDrawCommands.
+		static auto CommitDrawCommands(B deferText = false) -> V;
+		static auto CommitDeferredDrawCommands() -> V;
+		static auto Clear(B deferText = false) -> V;
 
 	private:
 	};
@@ -53,21 +68,20 @@ namespace WL
 	template<typename TRenderers>
 	inline auto Renderer<TRenderers>::Init() -> B
 	{
-		return
-			FontRenderer::Init() &&
-			BoxRenderer::Init() &&
-			ArcRenderer::Init() &&
-			LineRenderer::Init() &&
-			VectorRasterizer::Init() &&
-			BezierRenderer::Init();
+		return VectorRasterizer::Init() && BoxRenderer::Init();
 	}
 
 
 	template<typename TRenderers>
-	inline auto Renderer<TRenderers>::CommitDrawCommands() -> V
+	inline auto Renderer<TRenderers>::CommitDrawCommands(B deferText) -> V
 	{
-		FontRenderer::CommitDrawCommands();
+		if (!deferText)
+		{
+			FontRenderer::CommitDrawCommands();
+		}
 		BoxRenderer::CommitDrawCommands();
+		// Fills go under the outlines.
+		PathFillRenderer::CommitDrawCommands();
 		LineRenderer::CommitDrawCommands();
 		ArcRenderer::CommitDrawCommands();
 		BezierRenderer::CommitDrawCommands();
@@ -75,10 +89,21 @@ namespace WL
 	
 
 	template<typename TRenderers>
-	inline auto Renderer<TRenderers>::Clear() -> V
+	inline auto Renderer<TRenderers>::CommitDeferredDrawCommands() -> V
+	{
+		FontRenderer::CommitDrawCommands();
+	}
+
+
+	template<typename TRenderers>
+	inline auto Renderer<TRenderers>::Clear(B deferText) -> V
 	{
-		FontRenderer::Clear();
+		if (!deferText)
+		{
+			FontRenderer::Clear();
+		}
 		BoxRenderer::Clear();
+		PathFillRenderer::Clear();
 		LineRenderer::Clear();
 		ArcRenderer::Clear();
 		BezierRenderer::Clear();
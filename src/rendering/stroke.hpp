@@ -0,0 +1,80 @@
+// MIT License
+// 
+// Copyright (c) 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <common/types.hpp>
+#include <algebra/algebra.hpp>
+
+#include "color.hpp"
+
+
+namespace WL
+{
+	enum class EStrokeJoin : U32
+	{
+		Miter = 0,
+		Round,
+		Bevel
+	};
+
+	enum class EStrokeCap : U32
+	{
+		Butt = 0,
+		Round,
+		Square
+	};
+
+	// One segment of a joined stroke in render coordinates. The previous and
+	// next points are the control points of the neighbouring segments that
+	// are adjacent to the shared endpoints. The shaders split every join
+	// along the bisector of the two tangents so that each pixel is covered
+	// by exactly one segment.
+	struct StrokeSegment
+	{
+		ColorU32 color;
+		F32 widthBegin = 0.f;
+		F32 widthEnd = 0.f;
+		F32 feather = 1.f;
+		F32 miterLimit = 4.f;
+		EStrokeJoin join = EStrokeJoin::Miter;
+		EStrokeCap cap = EStrokeCap::Butt;
+		Vec2 previous;
+		Vec2 next;
+		B hasPrevious = false;
+		B hasNext = false;
+
+		// Bits 0-1 hold the join, 2-3 the cap, 4 and 5 tell whether there
+		// is a previous and a next segment.
+		auto GetFlags() const -> U32;
+	};
+}
+
+
+namespace WL
+{
+	inline auto StrokeSegment::GetFlags() const -> U32
+	{
+		return U32(join) | U32(cap) << 2 | U32(hasPrevious) << 4 | U32(hasNext) << 5;
+	}
+}
@@ -0,0 +1,193 @@
+// MIT License
+// 
+// Copyright (c) 2023 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <algorithm>
+
+#include <common/types.hpp>
+
+#include <algebra/algebra.hpp>
+
+namespace WL
+{
+	struct TextLayoutOptions
+	{
+		U32 fontIndex = 0;
+		// In pixels.
+		U32 fontHeight = 16;
+		// Lines are broken at spaces to fit, 0 keeps every paragraph on one line.
+		F32 maxWidth = 0.f;
+		B kerning = true;
+		// Snaps glyphs to whole pixels vertically and to subpixel phases
+		// horizontally, moving text stays crisp instead of being filtered.
+		B subpixelPositioning = false;
+
+		auto operator==(const TextLayoutOptions&) const -> B = default;
+	};
+
+	// Text laid out in pixels relative to the top-left corner of its box.
+	// Renderers cache the atlas quads of the glyphs in it as well, so drawing
+	// an unchanged run only copies them.
+	struct GlyphRun
+	{
+		struct Glyph
+		{
+			U32 codePoint;
+			// Pen position on the baseline.
+			F32 x;
+			F32 y;
+			F32 xAdvance;
+		};
+
+		struct Quad
+		{
+			U32 page;
+			U32 codePoint;
+			U32 phase;
+			Vec4 rect;
+			Vec4 uvs;
+		};
+
+		Array<I32> codepoints;
+		TextLayoutOptions options;
+
+		Array<Glyph> glyphs;
+		Array<U32> lineStarts;
+		F32 width = 0.f;
+		F32 height = 0.f;
+
+		Array<Quad> quads;
+		// Rasterizer generation the quads were resolved at.
+		U64 quadsGeneration = ~0ull;
+		// Fractional pixel position of the origin the quads were snapped
+		// for, only used with subpixel positioning.
+		F32 quadsOriginX = 0.f;
+		F32 quadsOriginY = 0.f;
+	};
+
+	template <typename TRasterizer>
+	class TextLayout
+	{
+	public:
+		using Rasterizer = TRasterizer;
+
+		// Lays the codepoints out unless the run already holds them with the
+		// same options. Returns whether the layout changed.
+		static auto Update(GlyphRun& run, Span<const I32> codepoints, const TextLayoutOptions& options) -> B;
+		static auto Layout(GlyphRun& run) -> V;
+	};
+}
+
+
+namespace WL
+{
+	template <typename TRasterizer>
+	auto TextLayout<TRasterizer>::Update(GlyphRun& run, Span<const I32> codepoints, const TextLayoutOptions& options) -> B
+	{
+		if (run.options == options && std::equal(codepoints.begin(), codepoints.end(), run.codepoints.begin(), run.codepoints.end()))
+		{
+			return false;
+		}
+
+		run.codepoints.assign(codepoints.begin(), codepoints.end());
+		run.options = options;
+		Layout(run);
+		return true;
+	}
+
+
+	template <typename TRasterizer>
+	auto TextLayout<TRasterizer>::Layout(GlyphRun& run) -> V
+	{
+		auto& options = run.options;
+		auto fontHeight = F32(options.fontHeight);
+		auto lineHeight = Rasterizer::GetLineHeight(options.fontIndex) * fontHeight;
+		auto baseline = Rasterizer::GetAscent(options.fontIndex) * fontHeight;
+
+		run.glyphs.clear();
+		run.glyphs.reserve(run.codepoints.size());
+		run.lineStarts.assign(1, 0);
+		run.quads.clear();
+		run.quadsGeneration = ~0ull;
+
+		auto penX = 0.f;
+		auto previous = -1;
+		// First glyph after the last space of the current line.
+		auto breakIndex = ~0u;
+
+		for (auto codepoint : run.codepoints)
+		{
+			if (codepoint == '\n')
+			{
+				run.lineStarts.push_back(run.glyphs.size());
+				baseline += lineHeight;
+				penX = 0.f;
+				previous = -1;
+				breakIndex = ~0u;
+				continue;
+			}
+
+			if (options.kerning && previous >= 0)
+			{
+				penX += Rasterizer::GetKerning(options.fontIndex, previous, codepoint) * fontHeight;
+			}
+
+			auto xAdvance = Rasterizer::GetAdvance(options.fontIndex, codepoint) * fontHeight;
+
+			if (options.maxWidth > 0.f && codepoint != ' ' && penX + xAdvance > options.maxWidth && breakIndex != ~0u)
+			{
+				// Move the word being laid out to a new line.
+				auto shift = breakIndex < run.glyphs.size()? run.glyphs[breakIndex].x : penX;
+				for (auto i = breakIndex; i < run.glyphs.size(); ++i)
+				{
+					run.glyphs[i].x -= shift;
+					run.glyphs[i].y += lineHeight;
+				}
+
+				run.lineStarts.push_back(breakIndex);
+				baseline += lineHeight;
+				penX -= shift;
+				breakIndex = ~0u;
+			}
+
+			run.glyphs.push_back({ .codePoint = U32(codepoint), .x = penX, .y = baseline, .xAdvance = xAdvance });
+			penX += xAdvance;
+			previous = codepoint;
+
+			if (codepoint == ' ')
+			{
+				breakIndex = run.glyphs.size();
+			}
+		}
+
+		run.width = 0.f;
+		for (auto& glyph : run.glyphs)
+		{
+			// Trailing spaces don't widen the box.
+			if (glyph.codePoint != ' ')
+			{
+				run.width = Max(run.width, glyph.x + glyph.xAdvance);
+			}
+		}
+		run.height = run.lineStarts.size() * lineHeight;
+	}
+}
@@ -46,7 +46,7 @@ namespace WL
 		using Buffer = GPUAPI::Buffer;
 		using Pso = GPUAPI::Pso;
 		using QuadDesc = QuadDesc2D<GPUAPI>;
-		auto Init() -> B;
+		auto Init(U32 variant) -> B;
 		auto AccumulateQuad(const QuadDesc& desc) -> V;
 		auto CommitDrawCommands() -> V;
 		auto Clear() -> V;
@@ -54,23 +54,30 @@ namespace WL
 		static constexpr U32 initialQuadInstancesCapacity = 1024;
 
 	private:
-		auto AllocateBuffers() -> B;
-		auto ReallocateBuffers(U32 newCapacity) -> B;
+		// Instances are bucketed by shader variant, see EQuadFeature.
+		struct Batch
+		{
+			U32 instanceCapacity = initialQuadInstancesCapacity;
+			U32 instances = 0;
+			B initialized = false;
+
+			Pso pso;
+			Buffer linearTransformsBuffer;
+			Buffer translationsBuffer;
+			Buffer uvsBuffer;
+			Buffer radiusesBuffer;
 
-		U32 instanceCapacity = initialQuadInstancesCapacity;
-		U32 instances = 0;
+			Array<Mat2x2> linearTransformsBufferCPU;
+			Array<Vec2> translationsBufferCPU;
+			Array<Vec4> uvsBufferCPU;
+			Array<F32> radiusesBufferCPU;
+		};
+
+		auto AllocateBuffers(Batch& batch) -> B;
+		auto ReallocateBuffers(Batch& batch, U32 newCapacity) -> B;
 
 		const Image* texture;
-		Pso pso;
-		Buffer linearTransformsBuffer;
-		Buffer translationsBuffer;
-		Buffer uvsBuffer;
-		Buffer radiusesBuffer;
-
-		Array<Mat2x2> linearTransformsBufferCPU;
-		Array<Vec2> translationsBufferCPU;
-		Array<Vec4> uvsBufferCPU;
-		Array<F32> radiusesBufferCPU;
+		StaticArray<Batch, CQuadVariants> batches;
 	};
 }
 
@@ -78,41 +85,57 @@ namespace WL
 namespace WL
 {
 	template<typename TPresentSurface>
-	inline auto TexturedQuadRenderer<TPresentSurface>::Init() -> B
+	inline auto TexturedQuadRenderer<TPresentSurface>::Init(U32 variant) -> B
 	{
-		if (!AllocateBuffers())
+		auto& batch = batches[variant];
+		if (batch.initialized)
+		{
+			return true;
+		}
+
+		if (!AllocateBuffers(batch))
 		{
 			return false;
 		}
 
-		pso.AddShader(TexturedQuadVert.data(), TexturedQuadVert.size(), EShaderType::Vertex);
-		pso.AddShader(TexturedQuadFrag.data(), TexturedQuadFrag.size(), EShaderType::Fragment);
+		auto& vert = SpecializeShader(TexturedQuadVert, variant, CQuadFeatureNames);
+		auto& frag = SpecializeShader(TexturedQuadFrag, variant, CQuadFeatureNames);
+		batch.pso.AddShader(vert.data(), vert.size(), EShaderType::Vertex);
+		batch.pso.AddShader(frag.data(), frag.size(), EShaderType::Fragment);
 
-		pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
-		pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 2 });
-		pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 4 });
-		pso.AddVBLayout({ .binding = 3, .type = EType::Float, .components = 1 });
-		pso.AddSimpleConstant(0, EType::Float, "uScreenDims");
-		pso.AddTexture(0, "uTexture0");
+		batch.pso.AddVBLayout({ .binding = 0, .type = EType::Float, .components = 4 });
+		batch.pso.AddVBLayout({ .binding = 1, .type = EType::Float, .components = 2 });
+		batch.pso.AddVBLayout({ .binding = 2, .type = EType::Float, .components = 4 });
+		batch.pso.AddVBLayout({ .binding = 3, .type = EType::Float, .components = 1 });
+		batch.pso.AddUniformBlock(CFrameConstantsBinding, "FrameConstants");
+		batch.pso.AddTexture(0, "uImage0");
 
-		return pso.Compile();
+		batch.initialized = batch.pso.BeginCompile();
+		return batch.initialized;
 	}
 
 
 	template<typename TPresentSurface>
 	inline auto TexturedQuadRenderer<TPresentSurface>::AccumulateQuad(const QuadDesc& desc) -> V
 	{
-		instances++;
-		if (instances > instanceCapacity)
+		auto variant = (desc.radius > 0.f)? U32(EQuadFeature::Rounded) : 0u;
+		auto& batch = batches[variant];
+		if (!Init(variant))
 		{
-			ReallocateBuffers(instanceCapacity * 2);
-			instanceCapacity *= 2;
+			return;
 		}
 
-		uvsBufferCPU.emplace_back(desc.u0, desc.v0, desc.u1, desc.v1);
-		radiusesBufferCPU.emplace_back(desc.radius);
-		linearTransformsBufferCPU.emplace_back(desc.width / 2.f, 0.f, 0.f, desc.height / 2.f);
-		translationsBufferCPU.emplace_back(desc.offsetX, desc.offsetY);
+		batch.instances++;
+		if (batch.instances > batch.instanceCapacity)
+		{
+			ReallocateBuffers(batch, batch.instanceCapacity * 2);
+			batch.instanceCapacity *= 2;
+		}
+
+		batch.uvsBufferCPU.emplace_back(desc.u0, desc.v0, desc.u1, desc.v1);
+		batch.radiusesBufferCPU.emplace_back(desc.radius);
+		batch.linearTransformsBufferCPU.emplace_back(desc.width / 2.f, 0.f, 0.f, desc.height / 2.f);
+		batch.translationsBufferCPU.emplace_back(desc.offsetX, desc.offsetY);
 		texture = desc.texture;
 	}
 
@@ -120,51 +143,53 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto TexturedQuadRenderer<TPresentSurface>::CommitDrawCommands() -> V
 	{
-		if (!instances)
+		for (auto& batch : batches)
 		{
-			return;
-		}
+			if (!batch.instances || !batch.pso.IsReady())
+			{
+				continue;
+			}
 
-		uvsBuffer.Update(uvsBufferCPU);
-		radiusesBuffer.Update(radiusesBufferCPU);
-		linearTransformsBuffer.Update(linearTransformsBufferCPU);
-		translationsBuffer.Update(translationsBufferCPU);
+			batch.uvsBuffer.Update(batch.uvsBufferCPU);
+			batch.radiusesBuffer.Update(batch.radiusesBufferCPU);
+			batch.linearTransformsBuffer.Update(batch.linearTransformsBufferCPU);
+			batch.translationsBuffer.Update(batch.translationsBufferCPU);
 
-		pso.Use();
-		pso.BindVB(0, linearTransformsBuffer, true);
-		pso.BindVB(1, translationsBuffer, true);
-		pso.BindVB(2, uvsBuffer, true);
-		pso.BindVB(3, radiusesBuffer, true);
+			batch.pso.Use();
+			batch.pso.BindVB(0, batch.linearTransformsBuffer, true);
+			batch.pso.BindVB(1, batch.translationsBuffer, true);
+			batch.pso.BindVB(2, batch.uvsBuffer, true);
+			batch.pso.BindVB(3, batch.radiusesBuffer, true);
 
-		pso.UpdateConstant(0, PresentSurface::GetDimensions());
-		pso.BindTexture(*texture);
+			batch.pso.BindTexture(*texture);
 
-		pso.DrawInstanced(0, DefaultQuad2D::verticesCount, instances);
+			batch.pso.DrawInstanced(0, DefaultQuad2D::verticesCount, batch.instances);
+		}
 
 		Clear();
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto TexturedQuadRenderer<TPresentSurface>::AllocateBuffers() -> B
+	inline auto TexturedQuadRenderer<TPresentSurface>::AllocateBuffers(Batch& batch) -> B
 	{
 		B status =
-			linearTransformsBuffer.Allocate(initialQuadInstancesCapacity, false) &&
-			translationsBuffer.Allocate(initialQuadInstancesCapacity, false) &&
-			uvsBuffer.Allocate(initialQuadInstancesCapacity, false) &&
-			radiusesBuffer.Allocate(initialQuadInstancesCapacity, false);
+			batch.linearTransformsBuffer.Allocate(initialQuadInstancesCapacity, false) &&
+			batch.translationsBuffer.Allocate(initialQuadInstancesCapacity, false) &&
+			batch.uvsBuffer.Allocate(initialQuadInstancesCapacity, false) &&
+			batch.radiusesBuffer.Allocate(initialQuadInstancesCapacity, false);
 		return status;
 	}
 
 
 	template<typename TPresentSurface>
-	inline auto TexturedQuadRenderer<TPresentSurface>::ReallocateBuffers(U32 newCapacity) -> B
+	inline auto TexturedQuadRenderer<TPresentSurface>::ReallocateBuffers(Batch& batch, U32 newCapacity) -> B
 	{
 		B status =
-			linearTransformsBuffer.Reallocate(newCapacity, false) &&
-			translationsBuffer.Reallocate(newCapacity, false) &&
-			uvsBuffer.Reallocate(newCapacity, false) &&
-			radiusesBuffer.Reallocate(newCapacity, false);
+			batch.linearTransformsBuffer.Reallocate(newCapacity, false) &&
+			batch.translationsBuffer.Reallocate(newCapacity, false) &&
+			batch.uvsBuffer.Reallocate(newCapacity, false) &&
+			batch.radiusesBuffer.Reallocate(newCapacity, false);
 		return status;
 	}
 
@@ -172,10 +197,13 @@ namespace WL
 	template<typename TPresentSurface>
 	inline auto TexturedQuadRenderer<TPresentSurface>::Clear() -> V
 	{
-		instances = 0;
-		uvsBufferCPU.clear();
-		radiusesBufferCPU.clear();
-		linearTransformsBufferCPU.clear();
-		translationsBufferCPU.clear();
+		for (auto& batch : batches)
+		{
+			batch.instances = 0;
+			batch.uvsBufferCPU.clear();
+			batch.radiusesBufferCPU.clear();
+			batch.linearTransformsBufferCPU.clear();
+			batch.translationsBufferCPU.clear();
+		}
 	}
 }
\ No newline at end of file
@@ -23,14 +23,70 @@
 
 #pragma once
 
+#include <common/concepts.hpp>
+
 #include <algebra/algebra.hpp>
 #include <algebra/bezier.hpp>
 #include <algebra/line.hpp>
 #include <rendering/color.hpp>
+#include <rendering/stroke.hpp>
 
 
 namespace WL
 {
+	enum class EPathPrimitive : U8
+	{
+		QuadraticBezier = 0,
+		CubicBezier,
+		Line
+	};
+
+	// Path primitives stored by type. Every type has its own packed array,
+	// the tags keep the order of the path and the indices locate each
+	// primitive in the array of its type.
+	template <typename TF>
+	class PathPrimitives
+	{
+	public:
+		using Scalar = TF;
+		using QuadraticBezier = QuadraticBezier<Scalar, 2>;
+		using CubicBezier = CubicBezier<Scalar, 2>;
+		using Line = Line<Scalar, 2>;
+		using Primitive = Variant<QuadraticBezier, CubicBezier, Line>;
+
+		auto Add(const QuadraticBezier& curve) -> V;
+		auto Add(const CubicBezier& curve) -> V;
+		auto Add(const Line& line) -> V;
+		auto Add(const Primitive& primitive) -> V;
+		auto Reserve(U32 count) -> V;
+		auto Clear() -> V;
+
+		auto GetSize() const -> U32;
+		auto IsEmpty() const -> B;
+		auto GetType(U32 i) const -> EPathPrimitive;
+		auto Get(U32 i) const -> Primitive;
+
+		auto GetQuadratics() const -> Span<const QuadraticBezier>;
+		auto GetCubics() const -> Span<const CubicBezier>;
+		auto GetLines() const -> Span<const Line>;
+
+		// Calls visitor with the i-th primitive as its concrete type.
+		template <typename TVisitor>
+		auto Visit(U32 i, TVisitor&& visitor) const -> V;
+		// Calls visitor with every primitive in path order as its concrete
+		// type, walking each type array sequentially.
+		template <typename TVisitor>
+		auto ForEach(TVisitor&& visitor) const -> V;
+
+	private:
+		Array<EPathPrimitive> types;
+		Array<U32> indices;
+		Array<QuadraticBezier> quadratics;
+		Array<CubicBezier> cubics;
+		Array<Line> lines;
+	};
+
+
 	template <typename TF>
 	struct Path2D
 	{
@@ -44,23 +100,185 @@ namespace WL
 		ColorU32 outlineColor;
 		F32 outlineWidth;
 		F32 outlineFeather = 2.f;
+		// When either is set the outline tapers from widthBegin to widthEnd
+		// along the path instead of using outlineWidth.
 		F32 widthBegin = 0;
 		F32 widthEnd = 0;
 		F32 outlineFeatherBegin = outlineFeather;
 		F32 outlineFeatherEnd = outlineFeather;
+		F32 miterLimit = 4.f;
+		EStrokeJoin join = EStrokeJoin::Miter;
+		EStrokeCap cap = EStrokeCap::Butt;
 		B outlined = false;
 		B filled = true;
 		B closed = false;
+		// Strokes every primitive on its own with the begin and end feathers
+		// instead of joining them.
+		B segmented = false;
 
 		auto CloneWithoutPrimitives() const -> Path2D;
 
-		Array<Primitive> primitives;
+		PathPrimitives<Scalar> primitives;
 	};
 }
 
 
 namespace WL
 {
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Add(const QuadraticBezier& curve) -> V
+	{
+		types.push_back(EPathPrimitive::QuadraticBezier);
+		indices.push_back(quadratics.size());
+		quadratics.push_back(curve);
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Add(const CubicBezier& curve) -> V
+	{
+		types.push_back(EPathPrimitive::CubicBezier);
+		indices.push_back(cubics.size());
+		cubics.push_back(curve);
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Add(const Line& line) -> V
+	{
+		types.push_back(EPathPrimitive::Line);
+		indices.push_back(lines.size());
+		lines.push_back(line);
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Add(const Primitive& primitive) -> V
+	{
+		WL::Visit<V>([&](const auto& p) -> V { Add(p); }, primitive);
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Reserve(U32 count) -> V
+	{
+		types.reserve(count);
+		indices.reserve(count);
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Clear() -> V
+	{
+		types.clear();
+		indices.clear();
+		quadratics.clear();
+		cubics.clear();
+		lines.clear();
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::GetSize() const -> U32
+	{
+		return types.size();
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::IsEmpty() const -> B
+	{
+		return types.empty();
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::GetType(U32 i) const -> EPathPrimitive
+	{
+		return types[i];
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::Get(U32 i) const -> Primitive
+	{
+		switch (types[i])
+		{
+			case EPathPrimitive::QuadraticBezier:
+				return quadratics[indices[i]];
+			case EPathPrimitive::CubicBezier:
+				return cubics[indices[i]];
+			default:
+				return lines[indices[i]];
+		}
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::GetQuadratics() const -> Span<const QuadraticBezier>
+	{
+		return { quadratics.data(), quadratics.size() };
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::GetCubics() const -> Span<const CubicBezier>
+	{
+		return { cubics.data(), cubics.size() };
+	}
+
+
+	template <typename TF>
+	inline auto PathPrimitives<TF>::GetLines() const -> Span<const Line>
+	{
+		return { lines.data(), lines.size() };
+	}
+
+
+	template <typename TF>
+	template <typename TVisitor>
+	inline auto PathPrimitives<TF>::Visit(U32 i, TVisitor&& visitor) const -> V
+	{
+		switch (types[i])
+		{
+			case EPathPrimitive::QuadraticBezier:
+				visitor(quadratics[indices[i]]);
+				break;
+			case EPathPrimitive::CubicBezier:
+				visitor(cubics[indices[i]]);
+				break;
+			default:
+				visitor(lines[indices[i]]);
+				break;
+		}
+	}
+
+
+	template <typename TF>
+	template <typename TVisitor>
+	inline auto PathPrimitives<TF>::ForEach(TVisitor&& visitor) const -> V
+	{
+		auto quadratic = quadratics.data();
+		auto cubic = cubics.data();
+		auto line = lines.data();
+		for (auto type : types)
+		{
+			switch (type)
+			{
+				case EPathPrimitive::QuadraticBezier:
+					visitor(*quadratic++);
+					break;
+				case EPathPrimitive::CubicBezier:
+					visitor(*cubic++);
+					break;
+				default:
+					visitor(*line++);
+					break;
+			}
+		}
+	}
+
+
 	template <typename TF>
 	inline auto Path2D<TF>::CloneWithoutPrimitives() const -> Path2D
 	{
@@ -71,6 +289,15 @@ namespace WL
 		result.outlineColor = outlineColor;
 		result.outlined = outlined;
 		result.outlineWidth = outlineWidth;
+		result.outlineFeather = outlineFeather;
+		result.widthBegin = widthBegin;
+		result.widthEnd = widthEnd;
+		result.outlineFeatherBegin = outlineFeatherBegin;
+		result.outlineFeatherEnd = outlineFeatherEnd;
+		result.miterLimit = miterLimit;
+		result.join = join;
+		result.cap = cap;
+		result.segmented = segmented;
 		return result;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,457 @@
+// MIT License
+// 
+// Copyright (c) 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#ifdef WL_USE_THREADS
+	#include <mutex>
+#endif
+
+#include <common/types.hpp>
+#include <common/disk_cache.hpp>
+#include <common/thread_pool.hpp>
+#include <common/error.hpp>
+#include <common/time.hpp>
+
+#include <algebra/arithmetic.hpp>
+
+#include "vector_path.hpp"
+
+
+namespace WL
+{
+	// Process wide cache of rasterized vector images keyed by the hash of
+	// the source and the pixel size. Images are reference counted, the ones
+	// nobody references are kept for reuse until they exceed the budget and
+	// are then evicted least recently used first.
+	template <typename TVectorRasterizer>
+	class VectorRasterCache
+	{
+	public:
+		using VectorRasterizer = TVectorRasterizer;
+		using GPUAPI = VectorRasterizer::GPUAPI;
+		using Image = GPUAPI::Image;
+		using Path2D = Path2D<F32>;
+
+		static constexpr U64 CDefaultBudget = 32 << 20;
+		static constexpr F64 CDefaultUploadBudgetUS = 2000;
+
+		static auto HashSource(Span<const Path2D> paths) -> U64;
+		static auto HashSource(StrView svg) -> U64;
+
+		// Return a referenced image of exactly the requested size,
+		// rasterizing it on the spot when it isn't cached.
+		static auto Acquire(Span<const Path2D> paths, U64 source, U32 width, U32 height) -> Image*;
+		static auto Acquire(StrView svg, U64 source, U32 width, U32 height) -> Image*;
+		// Returns a referenced image of exactly the requested size, nullptr
+		// if it isn't cached.
+		static auto TryAcquire(U64 source, U32 width, U32 height) -> Image*;
+		// Returns a referenced image of the cached size closest to the
+		// requested one, nullptr if the source has none.
+		static auto AcquireNearest(U64 source, U32 width, U32 height) -> Image*;
+		static auto Release(Image* image) -> V;
+
+		// Rasterize on the thread pool workers, the result becomes available
+		// to TryAcquire after a later Update. Without workers the jobs wait
+		// for Update, which runs them on the main thread. Repeated requests
+		// are ignored while one is pending.
+		static auto RasterizeAsync(Span<const Path2D> paths, U64 source, U32 width, U32 height) -> V;
+		static auto RasterizeAsync(StrView svg, U64 source, U32 width, U32 height) -> V;
+		static auto IsPending(U64 source, U32 width, U32 height) -> B;
+		// Uploads the finished background rasterizations, called once per
+		// frame on the main thread. Uploads stop once they took longer than
+		// the upload budget, the rest wait for the next frame. At least one
+		// is uploaded every frame. Without workers the queued rasterizations
+		// run in what is left of the budget, at least one when there were
+		// no uploads.
+		static auto Update() -> V;
+		static auto SetUploadBudget(F64 us) -> V;
+
+		// Bytes of unreferenced images kept around.
+		static auto SetBudget(U64 bytes) -> V;
+		static auto GetMemoryUsage() -> U64;
+
+	private:
+		struct Entry
+		{
+			U64 source;
+			U32 width;
+			U32 height;
+			Image* image;
+			U32 references = 0;
+			U64 lastUse = 0;
+		};
+
+		struct FinishedRaster
+		{
+			U64 source;
+			U32 width;
+			U32 height;
+			Array<Byte> pixels;
+		};
+
+		static auto GetKey(U64 source, U32 width, U32 height) -> U64;
+		static auto GetSize(const Entry& entry) -> U64;
+		static auto Insert(U64 source, U32 width, U32 height, const Byte* pixels) -> Entry&;
+		static auto Reference(Entry& entry) -> Image*;
+		static auto Finish(FinishedRaster&& raster) -> V;
+		static auto Schedule(Function<V()> job) -> V;
+		static auto Trim() -> V;
+
+		inline static Map<U64, Entry> entries;
+		inline static Map<Image*, U64> imageToKey;
+		inline static Set<U64> pending;
+		inline static U64 budget = CDefaultBudget;
+		inline static U64 memoryUsage = 0;
+		inline static U64 idleMemory = 0;
+		inline static U64 useTick = 1;
+		inline static F64 uploadBudget = CDefaultUploadBudgetUS;
+
+		inline static Deque<FinishedRaster> uploads;
+		// Rasterizations waiting for Update when there are no workers.
+		inline static Deque<Function<V()>> rasterJobs;
+		inline static Array<FinishedRaster> finished;
+	#ifdef WL_USE_THREADS
+		inline static std::mutex finishedMutex;
+	#endif
+	};
+}
+
+
+namespace WL
+{
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::HashSource(Span<const Path2D> paths) -> U64
+	{
+		auto hash = DiskCache::HashValue(U64(paths.size()));
+		for (auto& path : paths)
+		{
+			hash = DiskCache::HashValue(StaticArray<U32, 2>{ path.fillColor.packed, path.outlineColor.packed }, hash);
+			hash = DiskCache::HashValue(
+				StaticArray<F32, 8>
+				{
+					path.outlineWidth,
+					path.outlineFeather,
+					path.widthBegin,
+					path.widthEnd,
+					path.outlineFeatherBegin,
+					path.outlineFeatherEnd,
+					path.miterLimit,
+					F32(path.outlined | path.filled << 1 | path.closed << 2 | U32(path.join) << 3 | U32(path.cap) << 5)
+				},
+				hash
+			);
+
+			path.primitives.ForEach
+			(
+				[&](const auto& p) -> V
+				{
+					hash = DiskCache::HashValue(p.points, hash);
+				}
+			);
+		}
+
+		return hash;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::HashSource(StrView svg) -> U64
+	{
+		return DiskCache::Hash(Span<const Byte>((const Byte*)svg.data(), svg.size()));
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Acquire(Span<const Path2D> paths, U64 source, U32 width, U32 height) -> Image*
+	{
+		if (auto image = TryAcquire(source, width, height))
+		{
+			return image;
+		}
+
+		auto pixels = VectorRasterizer::Rasterize(paths, width, height);
+		return Reference(Insert(source, width, height, pixels.data()));
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Acquire(StrView svg, U64 source, U32 width, U32 height) -> Image*
+	{
+		if (auto image = TryAcquire(source, width, height))
+		{
+			return image;
+		}
+
+		auto pixels = VectorRasterizer::Rasterize(svg, width, height);
+		return Reference(Insert(source, width, height, pixels.data()));
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::TryAcquire(U64 source, U32 width, U32 height) -> Image*
+	{
+		auto it = entries.find(GetKey(source, width, height));
+		return it == entries.end()? nullptr : Reference(it->second);
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::AcquireNearest(U64 source, U32 width, U32 height) -> Image*
+	{
+		Entry* nearest = nullptr;
+		auto nearestDistance = ~0ull;
+		for (auto& [key, entry] : entries)
+		{
+			if (entry.source != source)
+			{
+				continue;
+			}
+
+			auto distance = U64(Abs(I64(entry.width) - I64(width))) + U64(Abs(I64(entry.height) - I64(height)));
+			if (distance < nearestDistance)
+			{
+				nearest = &entry;
+				nearestDistance = distance;
+			}
+		}
+
+		return nearest? Reference(*nearest) : nullptr;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Release(Image* image) -> V
+	{
+		auto it = imageToKey.find(image);
+		WL_ASSERT(it != imageToKey.end());
+
+		auto& entry = entries[it->second];
+		WL_ASSERT(entry.references);
+		entry.lastUse = useTick++;
+		if (--entry.references == 0)
+		{
+			idleMemory += GetSize(entry);
+			Trim();
+		}
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::RasterizeAsync(Span<const Path2D> paths, U64 source, U32 width, U32 height) -> V
+	{
+		auto key = GetKey(source, width, height);
+		if (entries.contains(key) || !pending.insert(key).second)
+		{
+			return;
+		}
+
+		Schedule(
+			[paths = Array<Path2D>(paths.begin(), paths.end()), source, width, height]()
+			{
+				Finish({ source, width, height, VectorRasterizer::Rasterize(paths, width, height) });
+			}
+		);
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::RasterizeAsync(StrView svg, U64 source, U32 width, U32 height) -> V
+	{
+		auto key = GetKey(source, width, height);
+		if (entries.contains(key) || !pending.insert(key).second)
+		{
+			return;
+		}
+
+		Schedule(
+			[svg = Str(svg), source, width, height]()
+			{
+				Finish({ source, width, height, VectorRasterizer::Rasterize(svg, width, height) });
+			}
+		);
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::IsPending(U64 source, U32 width, U32 height) -> B
+	{
+		return pending.contains(GetKey(source, width, height));
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Update() -> V
+	{
+		{
+		#ifdef WL_USE_THREADS
+			std::lock_guard lock(finishedMutex);
+		#endif
+			for (auto& raster : finished)
+			{
+				uploads.push_back(std::move(raster));
+			}
+			finished.clear();
+		}
+
+		// Not trimmed here, the results wait idle until the requesters pick
+		// them up.
+		auto start = GetTimeStampUS();
+		while (!uploads.empty())
+		{
+			auto& raster = uploads.front();
+			auto key = GetKey(raster.source, raster.width, raster.height);
+			pending.erase(key);
+			if (!entries.contains(key))
+			{
+				Insert(raster.source, raster.width, raster.height, raster.pixels.data());
+			}
+			uploads.pop_front();
+
+			if (GetTimeStampUS() - start > uploadBudget)
+			{
+				break;
+			}
+		}
+
+		// Finished rasters are uploaded by the next Update.
+		while (!rasterJobs.empty() && GetTimeStampUS() - start <= uploadBudget)
+		{
+			auto job = std::move(rasterJobs.front());
+			rasterJobs.pop_front();
+			job();
+		}
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::SetUploadBudget(F64 us) -> V
+	{
+		uploadBudget = us;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::SetBudget(U64 bytes) -> V
+	{
+		budget = bytes;
+		Trim();
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::GetMemoryUsage() -> U64
+	{
+		return memoryUsage;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::GetKey(U64 source, U32 width, U32 height) -> U64
+	{
+		return DiskCache::HashValue(StaticArray<U32, 2>{ width, height }, source);
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::GetSize(const Entry& entry) -> U64
+	{
+		return U64(entry.width) * entry.height * 4;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Insert(U64 source, U32 width, U32 height, const Byte* pixels) -> Entry&
+	{
+		auto image = new Image;
+		image->Allocate(EFormat::BGRA8, width, height);
+		image->InitData(pixels);
+
+		auto key = GetKey(source, width, height);
+		imageToKey[image] = key;
+		auto& entry = entries[key] = { .source = source, .width = width, .height = height, .image = image, .lastUse = useTick++ };
+		memoryUsage += GetSize(entry);
+		idleMemory += GetSize(entry);
+		return entry;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Reference(Entry& entry) -> Image*
+	{
+		if (entry.references++ == 0)
+		{
+			idleMemory -= GetSize(entry);
+		}
+		entry.lastUse = useTick++;
+		return entry.image;
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Finish(FinishedRaster&& raster) -> V
+	{
+	#ifdef WL_USE_THREADS
+		std::lock_guard lock(finishedMutex);
+	#endif
+		finished.push_back(std::move(raster));
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Schedule(Function<V()> job) -> V
+	{
+		if (GetThreadPool().GetThreadCount())
+		{
+			GetThreadPool().SubmitBackground(std::move(job));
+		}
+		else
+		{
+			rasterJobs.push_back(std::move(job));
+		}
+	}
+
+
+	template <typename TVectorRasterizer>
+	inline auto VectorRasterCache<TVectorRasterizer>::Trim() -> V
+	{
+		while (idleMemory > budget)
+		{
+			auto lru = entries.end();
+			for (auto it = entries.begin(); it != entries.end(); ++it)
+			{
+				if (!it->second.references && (lru == entries.end() || it->second.lastUse < lru->second.lastUse))
+				{
+					lru = it;
+				}
+			}
+
+			auto& entry = lru->second;
+			idleMemory -= GetSize(entry);
+			memoryUsage -= GetSize(entry);
+			imageToKey.erase(entry.image);
+			delete entry.image;
+			entries.erase(lru);
+		}
+	}
+}
@@ -26,6 +26,11 @@
 #include <plutosvg/plutovg/include/plutovg.h>
 #include <plutosvg/source/plutosvg.h>
 
+#include <common/disk_cache.hpp>
+#include <common/thread_pool.hpp>
+
+#include <algebra/arithmetic.hpp>
+
 #include "vector_rasterizer.hpp"
 #include "vector_path.hpp"
 
@@ -38,11 +43,22 @@ namespace WL
 		using GPUAPI = TGPUAPI;
 		using Image = GPUAPI::Image;
 		using Path2D = Path2D<F32>;
+
+		// Paths are binned into square tiles of this many pixels which are
+		// rasterized in parallel.
+		static constexpr U32 CTileSize = 256;
 		
 		static auto RasterizeToImage(Span<const Path2D> paths, Image* out) -> V;
 		static auto RasterizeToImage(StrView svg, Image* out) -> V;
+		// Return BGRA8 pixels without touching the GPU, safe to call from
+		// worker threads.
+		static auto Rasterize(Span<const Path2D> paths, U32 width, U32 height) -> Array<Byte>;
+		static auto Rasterize(StrView svg, U32 width, U32 height) -> Array<Byte>;
 		static auto Init() -> B;
 	private:
+		// Pixel bounds covered by the path including its outline, x0 y0 x1 y1.
+		static auto GetPathBounds(const Path2D& path, U32 width, U32 height) -> Vec4;
+		static auto DrawPath(plutovg_t* context, const Path2D& path, U32 width, U32 height) -> V;
 	};
 }
 
@@ -52,77 +68,204 @@ namespace WL
 	template<typename TGPUAPI>
 	inline auto VectorRasterizerCPU<TGPUAPI>::RasterizeToImage(Span<const Path2D> paths, Image* out) -> V
 	{
-		const auto width = out->width;
-		const auto height = out->height;
-		auto surface = plutovg_surface_create(width, height);
-		auto context = plutovg_create(surface);
+		auto pixels = Rasterize(paths, out->width, out->height);
+		out->InitData(pixels.data());
+	}
 
-		plutovg_set_operator(context, plutovg_operator_src);
 
-		for (auto& path : paths)
+	template<typename TGPUAPI>
+	inline auto VectorRasterizerCPU<TGPUAPI>::Rasterize(Span<const Path2D> paths, U32 width, U32 height) -> Array<Byte>
+	{
+		// Paths crossing tiles are flattened once per tile, without workers
+		// that is pure overhead.
+		const auto tileSize = GetThreadPool().GetThreadCount()? CTileSize : Max(Max(width, height), 1u);
+		const auto tilesX = (width + tileSize - 1) / tileSize;
+		const auto tilesY = (height + tileSize - 1) / tileSize;
+
+		// Keeps the path order within every tile.
+		Array<Array<U32>> tilePaths(tilesX * tilesY);
+		for (auto i = 0u; i < paths.size(); ++i)
 		{
-			plutovg_save(context);
+			auto bounds = GetPathBounds(paths[i], width, height);
+			if (bounds[2] < 0.f || bounds[3] < 0.f || bounds[0] >= width || bounds[1] >= height)
+			{
+				continue;
+			}
+
+			auto firstTileX = U32(Max(bounds[0], 0.f)) / tileSize;
+			auto firstTileY = U32(Max(bounds[1], 0.f)) / tileSize;
+			auto lastTileX = Min(U32(bounds[2]) / tileSize, tilesX - 1);
+			auto lastTileY = Min(U32(bounds[3]) / tileSize, tilesY - 1);
 
-			for (auto& prim : path.primitives)
+			for (auto y = firstTileY; y <= lastTileY; ++y)
 			{
-				if (HoldsAlternative<Path2D::Line>(prim))
+				for (auto x = firstTileX; x <= lastTileX; ++x)
 				{
-					auto& line = Get<Path2D::Line>(prim);
-					plutovg_move_to(context, line.p0[0] * width, line.p0[1] * height);
-					plutovg_line_to(context, line.p1[0] * width, line.p1[1] * height);
+					tilePaths[y * tilesX + x].push_back(i);
 				}
+			}
+		}
 
-				if (HoldsAlternative<Path2D::QuadraticBezier>(prim))
+		Array<Byte> pixels(U64(width) * height * 4);
+		const auto stride = width * 4;
+
+		GetThreadPool().ParallelFor(
+			tilePaths.size(),
+			[&](U32 tile)
+			{
+				if (tilePaths[tile].empty())
 				{
-					auto& qb = Get<Path2D::QuadraticBezier>(prim);
-					plutovg_move_to(context, qb.p0[0] * width, qb.p0[1] * height);
-					plutovg_quad_to(context, qb.p1[0] * width, qb.p1[1] * height, qb.p2[0] * width, qb.p2[1] * height);
+					return;
 				}
 
-				if (HoldsAlternative<Path2D::CubicBezier>(prim))
+				auto tileX = tile % tilesX * tileSize;
+				auto tileY = tile / tilesX * tileSize;
+				auto tileWidth = Min(tileSize, width - tileX);
+				auto tileHeight = Min(tileSize, height - tileY);
+
+				// The tiles are disjoint views into the output so they are
+				// rasterized in place.
+				auto surface = plutovg_surface_create_for_data(pixels.data() + tileY * stride + tileX * 4, tileWidth, tileHeight, stride);
+				auto context = plutovg_create(surface);
+
+				plutovg_set_operator(context, plutovg_operator_src);
+				plutovg_translate(context, -F64(tileX), -F64(tileY));
+
+				for (auto pathIndex : tilePaths[tile])
 				{
-					auto& cb = Get<Path2D::CubicBezier>(prim);
-					plutovg_move_to(context, cb.p0[0] * width, cb.p0[1] * height);
-					plutovg_cubic_to(context, cb.p1[0] * width, cb.p1[1] * height, cb.p2[0] * width, cb.p2[1] * height, cb.p3[0] * width, cb.p3[1] * height);
+					DrawPath(context, paths[pathIndex], width, height);
 				}
+
+				plutovg_destroy(context);
+				plutovg_surface_destroy(surface);
 			}
+		);
 
-			if (path.closed)
+		return pixels;
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto VectorRasterizerCPU<TGPUAPI>::GetPathBounds(const Path2D& path, U32 width, U32 height) -> Vec4
+	{
+		auto bounds = Vec4(1e30f, 1e30f, -1e30f, -1e30f);
+		path.primitives.ForEach
+		(
+			[&](const auto& p) -> V
 			{
-				plutovg_close_path(context);
+				// The control points bound the curves.
+				for (auto& point : p.points)
+				{
+					bounds[0] = Min(bounds[0], point[0] * width);
+					bounds[1] = Min(bounds[1], point[1] * height);
+					bounds[2] = Max(bounds[2], point[0] * width);
+					bounds[3] = Max(bounds[3], point[1] * height);
+				}
 			}
+		);
 
-			if (path.filled)
+		// Antialiasing reaches a pixel past the geometry, miter joins
+		// up to a few widths.
+		auto margin = 1.f + (path.outlined? path.outlineWidth * width * 2.f : 0.f);
+		return Vec4(bounds[0] - margin, bounds[1] - margin, bounds[2] + margin, bounds[3] + margin);
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto VectorRasterizerCPU<TGPUAPI>::DrawPath(plutovg_t* context, const Path2D& path, U32 width, U32 height) -> V
+	{
+		plutovg_save(context);
+		// Paths aren't part of the saved state, the previous one would be
+		// filled again with this path's paint.
+		plutovg_new_path(context);
+
+		// Primitives continuing the previous one extend its contour so the
+		// fill doesn't close every primitive on its own.
+		auto moveTo = [&, current = Vec2(-1e30f, -1e30f)](Vec2 start, Vec2 end) mutable
+		{
+			if (!(start == current))
 			{
-				auto color = path.fillColor.operator Color4();
-				plutovg_set_source_rgba(context, color[0], color[1], color[2], color[3]);
-				plutovg_fill_preserve(context);
+				plutovg_move_to(context, start[0] * width, start[1] * height);
 			}
-			if (path.outlined)
+			current = end;
+		};
+
+		path.primitives.ForEach
+		(
+			[&](const auto& p) -> V
 			{
-				auto color = path.outlineColor.operator Color4();
-				plutovg_set_source_rgba(context, color[0], color[1], color[2], color[3]);
-				plutovg_set_line_width(context, path.outlineWidth * width);
-				plutovg_stroke_preserve(context);
+				moveTo(p.points.front(), p.points.back());
+
+				if constexpr (CIsSame<decltype(p), typename Path2D::Line>)
+				{
+					plutovg_line_to(context, p.p1[0] * width, p.p1[1] * height);
+				}
+				else if constexpr (CIsSame<decltype(p), typename Path2D::QuadraticBezier>)
+				{
+					plutovg_quad_to(context, p.p1[0] * width, p.p1[1] * height, p.p2[0] * width, p.p2[1] * height);
+				}
+				else
+				{
+					plutovg_cubic_to(context, p.p1[0] * width, p.p1[1] * height, p.p2[0] * width, p.p2[1] * height, p.p3[0] * width, p.p3[1] * height);
+				}
 			}
-			plutovg_restore(context);
+		);
+
+		if (path.closed)
+		{
+			plutovg_close_path(context);
 		}
 
-		auto rasterizedData = plutovg_surface_get_data(surface);
-		out->InitData(rasterizedData);
-		plutovg_surface_destroy(surface);
-		plutovg_destroy(context);
+		if (path.filled)
+		{
+			auto color = path.fillColor.operator Color4();
+			plutovg_set_source_rgba(context, color[0], color[1], color[2], color[3]);
+			plutovg_fill_preserve(context);
+		}
+		if (path.outlined)
+		{
+			auto color = path.outlineColor.operator Color4();
+			plutovg_set_source_rgba(context, color[0], color[1], color[2], color[3]);
+			plutovg_set_line_width(context, path.outlineWidth * width);
+			plutovg_set_line_join(context, plutovg_line_join_t(path.join));
+			plutovg_set_line_cap(context, plutovg_line_cap_t(path.cap));
+			plutovg_set_miter_limit(context, path.miterLimit);
+			plutovg_stroke_preserve(context);
+		}
+		plutovg_restore(context);
 	}
 
 
 	template<typename TGPUAPI>
 	inline auto VectorRasterizerCPU<TGPUAPI>::RasterizeToImage(StrView svg, Image* out) -> V
 	{
-		auto surface = plutosvg_load_from_memory(svg.data(), svg.size(), nullptr, out->width, out->height, 0);
+		auto pixels = Rasterize(svg, out->width, out->height);
+		out->InitData(pixels.data());
+	}
+
+
+	template<typename TGPUAPI>
+	inline auto VectorRasterizerCPU<TGPUAPI>::Rasterize(StrView svg, U32 width, U32 height) -> Array<Byte>
+	{
+		const auto rasterSize = U64(width) * height * 4;
+		auto cacheKey = DiskCache::Hash(
+			Span<const Byte>((const Byte*)svg.data(), svg.size()),
+			DiskCache::HashValue(StaticArray<U32, 2>{ width, height })
+		);
+
+		auto cached = DiskCache::Load(cacheKey);
+		if (cached.size() == rasterSize)
+		{
+			return cached;
+		}
+
+		auto surface = plutosvg_load_from_memory(svg.data(), svg.size(), nullptr, width, height, 0);
 		WL_ASSERT(surface);
 		auto rasterizedData = plutovg_surface_get_data(surface);
-		out->InitData(rasterizedData);
+		Array<Byte> pixels(rasterizedData, rasterizedData + rasterSize);
+		DiskCache::Store(cacheKey, pixels);
 		plutovg_surface_destroy(surface);
+		return pixels;
 	}
 
 
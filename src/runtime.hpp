@@ -59,6 +59,7 @@ namespace WL
 		auto static UpdateWidgets(const UpdateState& updateState) -> V;
 		auto static ResizeLayers(U32 newSize) -> V;
 		inline static B widgetsAreDirty = true;
+		inline static B deferText = false;
 		inline static WidgetLayers widgetLayers;
 	};
 }
@@ -74,6 +75,11 @@ namespace WL
 			return false;
 		}
 		
+		if (cfg.useDiskCache)
+		{
+			DiskCache::Init(cfg.diskCacheDirectory);
+		}
+
 		if (!Renderer::FontRenderer::Rasterizer::Init())
 		{
 			return false;
@@ -81,7 +87,16 @@ namespace WL
 
 		if (cfg.useFontAtlases)
 		{
-			Renderer::FontRenderer::Rasterizer::BuildAtlases(cfg.defaultFontHeight, cfg.defaultFontRanges);
+			if (cfg.useSDFFontAtlases)
+			{
+				Renderer::FontRenderer::Rasterizer::BuildSDFAtlases(cfg.defaultFontRanges);
+			}
+			else
+			{
+				Array<U32> fontHeights = { cfg.defaultFontHeight };
+				fontHeights.insert(fontHeights.end(), cfg.extraFontHeights.begin(), cfg.extraFontHeights.end());
+				Renderer::FontRenderer::Rasterizer::BuildAtlases(fontHeights, cfg.defaultFontRanges);
+			}
 		}
 
 		if (!Renderer::Init())
@@ -90,8 +105,27 @@ namespace WL
 		}
 
 		GPUPresentSurface::EnableTransparency();
+		GPUPresentSurface::EnableDynamicResolution(cfg.dynamicResolution);
+		GPUPresentSurface::EnableAntiAliasing(cfg.antiAliasing);
 		GPUPresentSurface::AddRenderingCode([](){RenderWidgets();});
-		GPUPresentSurface::AddUpdateCode([](const UpdateState& us){UpdateWidgets(us);});
+
+		if (cfg.dynamicResolution.enabled && cfg.dynamicResolution.fullResolutionText)
+		{
+			// Text of the topmost layer is drawn on top of the upscaled scene
+			// at window resolution.
+			deferText = true;
+			GPUPresentSurface::AddOverlayRenderingCode([](){TRenderer::CommitDeferredDrawCommands();});
+		}
+		// The surface keeps a single update function.
+		GPUPresentSurface::AddUpdateCode
+		(
+			[](const UpdateState& us)
+			{
+				UpdateWidgets(us);
+				Renderer::VectorRasterCache::Update();
+				DiskCache::Flush();
+			}
+		);
 
 		ResizeLayers(8);
 
@@ -159,17 +193,27 @@ namespace WL
 	{
 		TGPUAPI::ClearPresentSurface();
 
-		for (auto& layer : widgetLayers)
+		// Deferred text ends up above everything in the scene, so only the
+		// topmost layer can defer without breaking the layer order.
+		auto topLayer = widgetLayers.size();
+		while (topLayer > 0 && widgetLayers[topLayer - 1].empty())
 		{
-			for (auto widgetPtr : layer)
+			topLayer--;
+		}
+
+		for (auto i = 0u; i < widgetLayers.size(); ++i)
+		{
+			for (auto widgetPtr : widgetLayers[i])
 			{
 				if (widgetPtr->isVisible)
 				{
 					widgetPtr->AccumulateDrawState();
 				}
 			}
-			TRenderer::CommitDrawCommands();
-			TRenderer::Clear();
+
+			auto deferLayerText = deferText && i + 1 == topLayer;
+			TRenderer::CommitDrawCommands(deferLayerText);
+			TRenderer::Clear(deferLayerText);
 		}
 	}
 
@@ -38,10 +38,63 @@ namespace WL
 		in float voutFeather;
 		in float voutFeatherBegin;
 		in float voutFeatherEnd;
+	#ifdef JOINED
+		in float voutWidthEnd;
+		in float voutMiterLimit;
+		in vec2 voutPrevious;
+		in vec2 voutNext;
+		flat in uint voutFlags;
+	#endif
 
 		out vec4 outColor;
 		
-		uniform vec2 uScreenDims;
+
+	#ifdef JOINED
+		// Signed distance to the end of the stroke at p where a is the
+		// outward tangent, b points into the neighbouring segment and h is
+		// the half width. Pixels past the bisector belong to the neighbour.
+		float strokeEnd(vec2 xy, vec2 p, vec2 a, vec2 b, float h, bool joined, uint join, uint cap)
+		{
+			vec2 xyp = xy - p;
+			float beyond = dot(xyp, a);
+
+			if (!joined)
+			{
+				if (cap == 1u)
+				{
+					return (beyond > 0.f)? length(xyp) - h : -h;
+				}
+				return (cap == 2u)? beyond - h : beyond;
+			}
+
+			// The neighbour sees the bisector normal negated, ties go to the
+			// side whose normal points left or down.
+			vec2 m = a + b;
+			float side = dot(xyp, m);
+			if (side > 0.f || (side == 0.f && (m.x < 0.f || (m.x == 0.f && m.y <= 0.f))))
+			{
+				return 1e4f;
+			}
+
+			// Inside of the turn the extended bands already meet.
+			vec2 outer = a - b;
+			if (dot(outer, outer) < 1e-6f || dot(xyp, outer) <= 0.f)
+			{
+				return -h;
+			}
+
+			float cosHalfTurn = sqrt(max(0.5f * (1.f + dot(a, b)), 0.f));
+			if (join == 1u)
+			{
+				return length(xyp) - h;
+			}
+			if (join == 0u && cosHalfTurn * voutMiterLimit >= 1.f)
+			{
+				return -h;
+			}
+			return dot(xyp, normalize(outer)) - h * cosHalfTurn;
+		}
+	#endif
 
 		void main()
 		{
@@ -77,8 +130,57 @@ namespace WL
 
 			vec2 grad = vec2(2.f * u * dUdx - dVdx, 2.f * u * dUdy - dVdy);
 
+		#ifdef JOINED
+			vec2 previous = (1.f + voutPrevious) / 2.f * uScreenDims;
+			vec2 next = (1.f + voutNext) / 2.f * uScreenDims;
+
+			vec2 a0 = normalize(p0 - p1);
+			vec2 a2 = normalize(p2 - p1);
+			float h0 = voutWidth * uScreenDims.x / 2.f;
+			float h2 = voutWidthEnd * uScreenDims.x / 2.f;
+
+			uint join = voutFlags & 3u;
+			uint cap = (voutFlags >> 2) & 3u;
+			bool hasPrevious = (voutFlags & 16u) != 0u;
+			bool hasNext = (voutFlags & 32u) != 0u;
+
+			// Past the endpoints the stroke continues along the end tangents
+			// instead of the rest of the parabola.
+			float beyond0 = dot(xy - p0, a0);
+			float beyond2 = dot(xy - p2, a2);
+			float dist = abs(implicit) / length(grad) - mix(h0, h2, clamp(u, 0.f, 1.f));
+			if (beyond0 > 0.f || beyond2 > 0.f)
+			{
+				dist = -1e4f;
+				if (beyond0 > 0.f)
+				{
+					dist = max(dist, abs(dot(xy - p0, vec2(-a0.y, a0.x))) - h0);
+				}
+				if (beyond2 > 0.f)
+				{
+					dist = max(dist, abs(dot(xy - p2, vec2(-a2.y, a2.x))) - h2);
+				}
+			}
+			dist = max(dist, strokeEnd(xy, p0, a0, hasPrevious? normalize(previous - p0) : -a0, h0, hasPrevious, join, cap));
+			dist = max(dist, strokeEnd(xy, p2, a2, hasNext? normalize(next - p2) : -a2, h2, hasNext, join, cap));
+
+			if (dist >= 1e4f)
+			{
+				discard;
+			}
+
+		#ifdef FEATHERED
+			float alpha = clamp(1.f - smoothstep(0.f, voutFeather, dist), 0.f, 1.f);
+		#else
+			float alpha = (dist > 0.f)? 0.f : 1.f;
+		#endif
+		#else
 			float approxDist = abs(implicit) / length(grad) - (voutWidth * uScreenDims.x) / 2.f;
+		#ifdef FEATHERED
 			float alpha = clamp(1.f - smoothstep(0.f, voutFeather, approxDist), 0.f, 1.f);
+		#else
+			float alpha = (approxDist > 0.f)? 0.f : 1.f;
+		#endif
 			
 
 			// Now cut out around the start and end control points.
@@ -93,6 +195,7 @@ namespace WL
 			vec2 xyp0T0N0 = vec2(dot(xyp0, n0), dot(xyp0, t0));
 			vec2 xyp2T1N1 = vec2(dot(xyp2, n1), dot(xyp2, t1));
 
+		#ifdef FEATHERED
 			if (xyp0T0N0.y > 0.f)
 			{
 				float dist = length(xyp0T0N0);
@@ -106,11 +209,17 @@ namespace WL
 				float fadeout = (voutFeatherEnd > 0.f)? voutFeatherEnd : voutFeather;
 				alpha *= clamp(1.f - smoothstep(0.f, fadeout, dist), 0.f, 1.f);
 			}
-
-			if (voutFeatherBegin < 0.f)
+		#else
+			if (xyp0T0N0.y > 0.f || xyp2T1N1.y > 0.f)
 			{
-				alpha *= clamp(1.f - smoothstep(0.f, -voutFeatherBegin + xyp0T0N0.x, l0), 0.f, 1.f);
+				alpha = 0.f;
 			}
+		#endif
+
+		#ifdef CUT_BEGIN
+			alpha *= clamp(1.f - smoothstep(0.f, -voutFeatherBegin + xyp0T0N0.x, l0), 0.f, 1.f);
+		#endif
+		#endif
 
 			outColor = vec4(voutColor.rgb, alpha);
 		}
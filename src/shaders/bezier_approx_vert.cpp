@@ -32,8 +32,11 @@ namespace WL
 
 		layout(location = 0) in uvec4 packedPointsAndColor;
 		layout(location = 1) in vec4 dims;
+	#ifdef JOINED
+		layout(location = 2) in vec4 neighbours;
+		layout(location = 3) in uint flags;
+	#endif
 
-		uniform vec2 uScreenDims;
 
         out vec4 voutColor;
 		out vec2 voutP0;
@@ -43,6 +46,13 @@ namespace WL
 		out float voutFeather;
 		out float voutFeatherBegin;
 		out float voutFeatherEnd;
+	#ifdef JOINED
+		out float voutWidthEnd;
+		out float voutMiterLimit;
+		out vec2 voutPrevious;
+		out vec2 voutNext;
+		flat out uint voutFlags;
+	#endif
 
 		vec2 UVs[3] = vec2[3]
 		(
@@ -76,7 +86,20 @@ namespace WL
 			voutFeather = dims.y;
 			voutFeatherBegin = dims.z;
 			voutFeatherEnd = dims.w;
+		#ifdef JOINED
+			// dims holds the begin width, feather, end width and miter limit.
+			voutWidthEnd = dims.z;
+			voutMiterLimit = dims.w;
+			voutPrevious = neighbours.xy;
+			voutNext = neighbours.zw;
+			voutFlags = flags;
+
+			float feather = voutFeather;
+			float reach = max(voutWidth, voutWidthEnd) * max(voutMiterLimit, 1.5f);
+		#else
 			float feather = max(voutFeather, max(voutFeatherBegin, voutFeatherEnd));
+			float reach = voutWidth;
+		#endif
 
 			vec2 p[3] = vec2[3]
 			(
@@ -93,7 +116,7 @@ namespace WL
 			vec2 p2p0 = normalize(p[0] - p[2]);
 			vec2 n2 = vec2(-p2p0.y, p2p0.x);
 
-			float offsetScale = 2.f * (voutWidth + (feather + 2.f) / uScreenDims.x);
+			float offsetScale = 2.f * (reach + (feather + 2.f) / uScreenDims.x);
 
 			vec2 line0P = p[0] + offsetScale * n0;
 			vec2 line1P = p[1] + offsetScale * n1;
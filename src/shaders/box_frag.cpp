@@ -37,7 +37,6 @@ namespace WL
 
 		out vec4 outColor;
 		
-		uniform vec2 uScreenDims;
 
 		float roundedBoxSDF(vec2 directionFromCenter, vec2 halfSide, float radius)
 		{
@@ -47,11 +46,10 @@ namespace WL
 		void main()
 		{
 			float alpha = 1.f;
-			if (voutRadius > 0.f)
-			{
-				float dist = roundedBoxSDF(gl_FragCoord.xy - voutCenterScreen * uScreenDims, voutDims / 2.f * uScreenDims, voutRadius * uScreenDims.x);
-				alpha = 1.f - smoothstep(0.f, 1.f, dist);
-			}
+		#ifdef ROUNDED
+			float dist = roundedBoxSDF(gl_FragCoord.xy - voutCenterScreen * uScreenDims, voutDims / 2.f * uScreenDims, voutRadius * uScreenDims.x);
+			alpha = 1.f - smoothstep(0.f, 1.f, dist);
+		#endif
 			outColor = vec4(voutColor.xyz, voutColor.w * alpha);
 		}
 	)";
@@ -36,7 +36,6 @@ namespace WL
 
 		out vec4 outColor;
 		
-		uniform vec2 uScreenDims;
 
 		float arcSDF(vec2 position, vec2 center, float outerRadius, float innerRadius)
 		{
@@ -37,7 +37,6 @@ namespace WL
 		out vec4 voutParams;
 		out vec4 voutColor;
 
-		uniform vec2 uScreenDims;
 
 		void main()
 		{
@@ -24,6 +24,9 @@
 #pragma once
 
 #include <common/types.hpp>
+#include <algebra/algebra.hpp>
+
+#include "variants.hpp"
 
 #define DEFINE_SHADER(SHADER_NAME) extern Str SHADER_NAME;
 
@@ -31,6 +34,8 @@ namespace WL
 {
     DEFINE_SHADER(FontAtlasTextVert);
     DEFINE_SHADER(FontAtlasTextFrag);
+    DEFINE_SHADER(FontOutlineTextVert);
+    DEFINE_SHADER(FontOutlineTextFrag);
     DEFINE_SHADER(TexturedQuadVert);
     DEFINE_SHADER(TexturedQuadFrag);
     DEFINE_SHADER(BoxVert);
@@ -41,4 +46,21 @@ namespace WL
     DEFINE_SHADER(CircularArcFrag);
     DEFINE_SHADER(BezierApproxVert);
     DEFINE_SHADER(BezierApproxFrag);
+    DEFINE_SHADER(PathFillVert);
+    DEFINE_SHADER(PathFillFrag);
+    DEFINE_SHADER(FrameConstantsBlock);
+
+    // std140 mirror of the FrameConstants uniform block which is shared by
+    // all programs and updated once per pass.
+    struct FrameConstants
+    {
+        Vec2 screenDims;
+        F32 time;
+        F32 dpiScale;
+        Mat4x4 viewTransform;
+    };
+
+    static_assert(sizeof(FrameConstants) == 80);
+
+    inline static constexpr U32 CFrameConstantsBinding = 0;
 }
\ No newline at end of file
@@ -34,12 +34,19 @@ namespace WL
 
 		out vec4 outColor;
 		
-		uniform vec2 uScreenDims;
 		uniform sampler2D uImage0;
 
 		void main()
 		{
+		#ifdef SDF
+			// Distances are stored around 0.5, fwidth keeps the edge a pixel
+			// wide at every scale.
+			float dist = texture(uImage0, voutUV).r;
+			float edgeWidth = max(fwidth(dist), 1e-4f);
+			float alpha = clamp((dist - 0.5f) / edgeWidth + 0.5f, 0.f, 1.f);
+		#else
 			float alpha = texture(uImage0, voutUV).r;
+		#endif
 			outColor = vec4(voutColor.rgb, alpha);
 		}
 	)";
@@ -0,0 +1,122 @@
+// MIT License
+// 
+// Copyright (c) 2023 - 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "common.hpp"
+
+namespace WL
+{
+
+	// Coverage of quadratic outlines along a horizontal ray, the roots of
+	// y(t) = 0 for the curves relative to the sample are found analytically
+	// and each crossing contributes its distance to the sample in pixels.
+	// Which roots are crossings is decided from the signs of the control
+	// points y coordinates, so shared endpoints and tangents are counted
+	// once (see Lengyel, "GPU-Centered Font Rendering Directly from Glyph
+	// Outlines").
+	Str FontOutlineTextFrag =
+		R"( #version 300 es
+		precision highp float;
+		precision highp int;
+		precision highp usampler2D;
+
+		in vec2 voutGlyphCoords;
+		flat in uint voutBandsOffset;
+		in vec4 voutColor;
+
+		out vec4 outColor;
+
+		uniform sampler2D uCurves;
+		uniform usampler2D uBands;
+
+		// Must match FontRasterizerGPU::CTextureWidth.
+		const uint textureWidth = 1024u;
+
+		ivec2 TexelCoords(uint idx)
+		{
+			return ivec2(idx % textureWidth, idx / textureWidth);
+		}
+
+		void main()
+		{
+			float pixelsPerUnit = 1.f / max(fwidth(voutGlyphCoords.x), 1e-6f);
+
+			uvec4 header = texelFetch(uBands, TexelCoords(voutBandsOffset), 0);
+			float minY = uintBitsToFloat(header.y);
+			float invBandHeight = uintBitsToFloat(header.z);
+			uint band = uint(clamp(int((voutGlyphCoords.y - minY) * invBandHeight), 0, int(header.x) - 1));
+
+			uvec4 bandDesc = texelFetch(uBands, TexelCoords(voutBandsOffset + 1u + band), 0);
+
+			float coverage = 0.f;
+			for (uint i = 0u; i < bandDesc.y; ++i)
+			{
+				uint curveIdx = texelFetch(uBands, TexelCoords(bandDesc.x + i / 4u), 0)[i % 4u];
+				vec4 p01 = texelFetch(uCurves, TexelCoords(curveIdx), 0);
+				vec2 p0 = p01.xy - voutGlyphCoords;
+				vec2 p1 = p01.zw - voutGlyphCoords;
+				vec2 p2 = texelFetch(uCurves, TexelCoords(curveIdx + 1u), 0).xy - voutGlyphCoords;
+
+				uint shift = (p0.y > 0.f ? 2u : 0u) + (p1.y > 0.f ? 4u : 0u) + (p2.y > 0.f ? 8u : 0u);
+				uint code = (0x2E74u >> shift) & 3u;
+
+				if (code == 0u)
+				{
+					continue;
+				}
+
+				vec2 a = p0 - p1 * 2.f + p2;
+				vec2 b = p0 - p1;
+				float d = sqrt(max(b.y * b.y - a.y * p0.y, 0.f));
+
+				float t0;
+				float t1;
+				if (abs(a.y) < 1e-5f)
+				{
+					t0 = t1 = p0.y * 0.5f / b.y;
+				}
+				else
+				{
+					t0 = (b.y - d) / a.y;
+					t1 = (b.y + d) / a.y;
+				}
+
+				float x0 = (a.x * t0 - b.x * 2.f) * t0 + p0.x;
+				float x1 = (a.x * t1 - b.x * 2.f) * t1 + p0.x;
+
+				if ((code & 1u) != 0u)
+				{
+					coverage += clamp(x0 * pixelsPerUnit + 0.5f, 0.f, 1.f);
+				}
+
+				if (code > 1u)
+				{
+					coverage -= clamp(x1 * pixelsPerUnit + 0.5f, 0.f, 1.f);
+				}
+			}
+
+			float alpha = clamp(abs(coverage), 0.f, 1.f);
+			outColor = vec4(voutColor.rgb, voutColor.a * alpha);
+		}
+	)";
+
+}
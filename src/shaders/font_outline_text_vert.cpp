@@ -0,0 +1,72 @@
+// MIT License
+// 
+// Copyright (c) 2023 - 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "common.hpp"
+
+namespace WL
+{
+
+	Str FontOutlineTextVert =
+		R"( #version 300 es
+		precision highp float;
+
+		layout(location = 0) in vec4 rect;
+		layout(location = 1) in vec4 glyphBox;
+		layout(location = 2) in uint bandsOffset;
+		layout(location = 3) in uint color;
+
+		out vec2 voutGlyphCoords;
+		flat out uint voutBandsOffset;
+		out vec4 voutColor;
+
+		vec2 corners[6] = vec2[6]
+		(
+			vec2(0.f, 0.f),
+			vec2(1.f, 0.f),
+			vec2(0.f, 1.f),
+
+			vec2(0.f, 1.f),
+			vec2(1.f, 0.f),
+			vec2(1.f, 1.f)
+		);
+
+		void main()
+		{
+			vec2 corner = corners[gl_VertexID];
+			vec2 outPos = mix(rect.xy, rect.zw, corner);
+
+			gl_Position = vec4(outPos.x, outPos.y, 0.f, 1.f);
+
+			voutColor = vec4(
+							  (color >> 24) & 0xFFu,
+							  (color >> 16) & 0xFFu,
+							  (color >> 8) & 0xFFu,
+							  color & 0xFFu
+						   ) / 255.f;
+
+			voutGlyphCoords = mix(glyphBox.xy, glyphBox.zw, corner);
+			voutBandsOffset = bandsOffset;
+		}
+	)";
+
+}
@@ -37,16 +37,101 @@ namespace WL
 		in float voutFeather;
 		in float voutFeatherBegin;
 		in float voutFeatherEnd;
+	#ifdef JOINED
+		in float voutWidthEnd;
+		in float voutMiterLimit;
+		in vec2 voutPrevious;
+		in vec2 voutNext;
+		flat in uint voutFlags;
+	#endif
 
 		out vec4 outColor;
 		
-		uniform vec2 uScreenDims;
+
+	#ifdef JOINED
+		// Signed distance to the end of the stroke at p where a is the
+		// outward tangent, b points into the neighbouring segment and h is
+		// the half width. Pixels past the bisector belong to the neighbour.
+		float strokeEnd(vec2 xy, vec2 p, vec2 a, vec2 b, float h, bool joined, uint join, uint cap)
+		{
+			vec2 xyp = xy - p;
+			float beyond = dot(xyp, a);
+
+			if (!joined)
+			{
+				if (cap == 1u)
+				{
+					return (beyond > 0.f)? length(xyp) - h : -h;
+				}
+				return (cap == 2u)? beyond - h : beyond;
+			}
+
+			// The neighbour sees the bisector normal negated, ties go to the
+			// side whose normal points left or down.
+			vec2 m = a + b;
+			float side = dot(xyp, m);
+			if (side > 0.f || (side == 0.f && (m.x < 0.f || (m.x == 0.f && m.y <= 0.f))))
+			{
+				return 1e4f;
+			}
+
+			// Inside of the turn the extended bands already meet.
+			vec2 outer = a - b;
+			if (dot(outer, outer) < 1e-6f || dot(xyp, outer) <= 0.f)
+			{
+				return -h;
+			}
+
+			float cosHalfTurn = sqrt(max(0.5f * (1.f + dot(a, b)), 0.f));
+			if (join == 1u)
+			{
+				return length(xyp) - h;
+			}
+			if (join == 0u && cosHalfTurn * voutMiterLimit >= 1.f)
+			{
+				return -h;
+			}
+			return dot(xyp, normalize(outer)) - h * cosHalfTurn;
+		}
+	#endif
 
 		void main()
 		{
 			vec2 p0 = vec2((1.f + voutP0.x) / 2.f, (1.f + voutP0.y) / 2.f) * uScreenDims;
 			vec2 p1 = vec2((1.f + voutP1.x) / 2.f, (1.f + voutP1.y) / 2.f) * uScreenDims;
 
+		#ifdef JOINED
+			vec2 xy = gl_FragCoord.xy + 0.5f;
+			vec2 previous = (1.f + voutPrevious) / 2.f * uScreenDims;
+			vec2 next = (1.f + voutNext) / 2.f * uScreenDims;
+
+			vec2 t = normalize(p1 - p0);
+			vec2 n = vec2(-t.y, t.x);
+			float s = clamp(dot(xy - p0, t) / length(p1 - p0), 0.f, 1.f);
+			float h0 = voutWidth * uScreenDims.x / 2.f;
+			float h1 = voutWidthEnd * uScreenDims.x / 2.f;
+
+			uint join = voutFlags & 3u;
+			uint cap = (voutFlags >> 2) & 3u;
+			bool hasPrevious = (voutFlags & 16u) != 0u;
+			bool hasNext = (voutFlags & 32u) != 0u;
+
+			float dist = abs(dot(xy - p0, n)) - mix(h0, h1, s);
+			dist = max(dist, strokeEnd(xy, p0, -t, hasPrevious? normalize(previous - p0) : t, h0, hasPrevious, join, cap));
+			dist = max(dist, strokeEnd(xy, p1, t, hasNext? normalize(next - p1) : -t, h1, hasNext, join, cap));
+
+			if (dist >= 1e4f)
+			{
+				discard;
+			}
+
+		#ifdef FEATHERED
+			float alpha = clamp(1.f - smoothstep(0.f, voutFeather, dist), 0.f, 1.f);
+		#else
+			float alpha = (dist > 0.f)? 0.f : 1.f;
+		#endif
+		#else
+
 			vec2 p0p1 = p1 - p0;
 
 
@@ -56,7 +141,11 @@ namespace WL
 
 			float dist = abs(dot(p0p1, vec2(p1.y - y, p0.x - x))) / length(p0p1) - voutWidth * uScreenDims.x / 2.f;
 
+		#ifdef FEATHERED
 			float alpha = clamp(1.f - smoothstep(0.f, voutFeather, dist), 0.f, 1.f);
+		#else
+			float alpha = (dist > 0.f)? 0.f : 1.f;
+		#endif
 			
 			// Now cut out around the start and end points.
 			vec2 t = normalize(p0 - p1);
@@ -68,6 +157,7 @@ namespace WL
 			vec2 xyp0TN = vec2(dot(xyp0, n), dot(xyp0, t));
 			vec2 xyp1TN = vec2(dot(xyp1, n), dot(xyp1, -t));
 
+		#ifdef FEATHERED
 			if (xyp0TN.y > 0.f)
 			{
 				float dist = xyp0TN.y;
@@ -79,6 +169,13 @@ namespace WL
 				float dist = xyp1TN.y;
 				alpha *= clamp(1.f - smoothstep(0.f, voutFeatherEnd, dist), 0.f, 1.f);
 			}
+		#else
+			if (xyp0TN.y > 0.f || xyp1TN.y > 0.f)
+			{
+				alpha = 0.f;
+			}
+		#endif
+		#endif
 
 			outColor = vec4(voutColor.rgb, alpha);
 		}
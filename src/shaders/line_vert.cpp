@@ -33,8 +33,11 @@ namespace WL
 		layout(location = 0) in vec4 points;
 		layout(location = 1) in uint color;
 		layout(location = 2) in vec4 dims;
+	#ifdef JOINED
+		layout(location = 3) in vec4 neighbours;
+		layout(location = 4) in uint flags;
+	#endif
 
-		uniform vec2 uScreenDims;
 
         out vec4 voutColor;
 		out vec2 voutP0;
@@ -43,6 +46,13 @@ namespace WL
 		out float voutFeather;
 		out float voutFeatherBegin;
 		out float voutFeatherEnd;
+	#ifdef JOINED
+		out float voutWidthEnd;
+		out float voutMiterLimit;
+		out vec2 voutPrevious;
+		out vec2 voutNext;
+		flat out uint voutFlags;
+	#endif
 
 
 		void main()
@@ -54,6 +64,35 @@ namespace WL
 			voutP0 = points.xy;
 			voutP1 = points.zw;
 
+		#ifdef JOINED
+			// dims holds the begin width, feather, end width and miter limit.
+			voutWidthEnd = dims.z;
+			voutMiterLimit = dims.w;
+			voutPrevious = neighbours.xy;
+			voutNext = neighbours.zw;
+			voutFlags = flags;
+
+			// Cover the widest end and leave room for the joins and caps
+			// which reach at most miterLimit half widths past the endpoints.
+			vec2 p0 = (1.f + voutP0) / 2.f * uScreenDims;
+			vec2 p1 = (1.f + voutP1) / 2.f * uScreenDims;
+			vec2 t = normalize(p1 - p0);
+			vec2 n = vec2(-t.y, t.x);
+			float side = max(dims.x, dims.z) * uScreenDims.x / 2.f + voutFeather + 1.f;
+			float ext = side * max(voutMiterLimit, 1.5f);
+
+			vec2 boundingRect[6] = vec2[6]
+			(
+				p0 - t * ext - n * side,
+				p0 - t * ext + n * side,
+				p1 + t * ext - n * side,
+				p1 + t * ext - n * side,
+				p1 + t * ext + n * side,
+				p0 - t * ext + n * side
+			);
+
+			gl_Position = vec4(boundingRect[gl_VertexID] / uScreenDims * 2.f - 1.f, 0.f, 1.f);
+		#else
 			vec2 dir = voutP0 - voutP1;
 			vec2 norm = vec2(-dir.y, dir.x);
 
@@ -71,6 +110,7 @@ namespace WL
 			);
 
 			gl_Position = vec4(boundingRect[gl_VertexID], 0.f, 1.f);
+		#endif
 
 			voutColor = vec4(
 							  (color >> 24) & 0xFFu,
@@ -37,7 +37,6 @@ namespace WL
 
 		out vec4 outColor;
 		
-		uniform vec2 uScreenDims;
 		uniform sampler2D uImage0;
 
 		float roundedBoxSDF(vec2 directionFromCenter, vec2 halfSide, float radius)
@@ -48,11 +47,10 @@ namespace WL
 		void main()
 		{
 			float alpha = 1.f;
-			if (voutRadius > 0.f)
-			{
-				float dist = roundedBoxSDF(gl_FragCoord.xy - voutCenterScreen * uScreenDims, voutDims / 2.f * uScreenDims, voutRadius * uScreenDims.x);
-				alpha = 1.f - smoothstep(0.f, 1.f, dist * 0.5f);
-			}
+		#ifdef ROUNDED
+			float dist = roundedBoxSDF(gl_FragCoord.xy - voutCenterScreen * uScreenDims, voutDims / 2.f * uScreenDims, voutRadius * uScreenDims.x);
+			alpha = 1.f - smoothstep(0.f, 1.f, dist * 0.5f);
+		#endif
 			vec4 avgSample = texture(uImage0, voutUV);
 			outColor = vec4(avgSample.rgb, alpha * avgSample.a);
 		}
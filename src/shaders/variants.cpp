@@ -0,0 +1,60 @@
+// MIT License
+// 
+// Copyright (c) 2023 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "common.hpp"
+
+namespace WL
+{
+    auto SpecializeShader(const Str& source, U32 features, Span<const C* const> featureNames) -> const Str&
+    {
+        static Map<const Str*, Map<U32, Str>> cache;
+
+        auto& variants = cache[&source];
+        auto it = variants.find(features);
+        if (it != variants.end())
+        {
+            return it->second;
+        }
+
+        auto versionPos = source.find("#version");
+        auto insertPos = (versionPos == Str::npos) ? 0 : source.find('\n', versionPos) + 1;
+
+        Str defines;
+        for (U32 i = 0; i < featureNames.size(); ++i)
+        {
+            if (features & (1u << i))
+            {
+                defines += "#define ";
+                defines += featureNames[i];
+                defines += "\n";
+            }
+        }
+
+        defines += FrameConstantsBlock;
+
+        auto& result = variants[features];
+        result = source;
+        result.insert(insertPos, defines);
+        return result;
+    }
+}
@@ -0,0 +1,72 @@
+// MIT License
+// 
+// Copyright (c) 2023 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <common/types.hpp>
+
+namespace WL
+{
+    // Renderers bucket their instances per variant and draw the buckets in
+    // turn, so instances of different variants don't keep their submission
+    // order within a layer.
+
+    // Feature bits of the quad shaders (box and textured quad).
+    enum class EQuadFeature : U32
+    {
+        Rounded = 1 << 0,
+    };
+
+    inline static constexpr U32 CQuadVariants = 2;
+    inline static const C* const CQuadFeatureNames[] = { "ROUNDED" };
+
+    // Feature bits of the stroke shaders (line and bezier).
+    enum class EStrokeFeature : U32
+    {
+        Feathered = 1 << 0,
+        // Only used by bezier strokes with a negative begin feather.
+        CutBegin = 1 << 1,
+        // Segments of a stroke with joins, caps and tapered width, see
+        // StrokeSegment.
+        Joined = 1 << 2
+    };
+
+    inline static constexpr U32 CLineVariants = 8;
+    inline static constexpr U32 CBezierVariants = 8;
+    inline static const C* const CStrokeFeatureNames[] = { "FEATHERED", "CUT_BEGIN", "JOINED" };
+
+    // Feature bits of the atlas text shaders.
+    enum class EFontFeature : U32
+    {
+        // The atlas holds signed distances instead of coverage.
+        SDF = 1 << 0
+    };
+
+    inline static constexpr U32 CFontVariants = 2;
+    inline static const C* const CFontFeatureNames[] = { "SDF" };
+
+    // Returns the source with a #define for every set feature bit and the
+    // FrameConstants block inserted right after the #version directive.
+    // Results are cached since PSOs keep pointers to their shader sources.
+    auto SpecializeShader(const Str& source, U32 features = 0, Span<const C* const> featureNames = {}) -> const Str&;
+}
@@ -26,11 +26,16 @@
 #include <rendering/font_renderer.hpp>
 #include <rendering/font_rasterizer.hpp>
 #include <rendering/font_rasterizer_cpu.hpp>
+#include <rendering/font_rasterizer_gpu.hpp>
+#include <rendering/font_renderer_gpu.hpp>
+#include <rendering/text_layout.hpp>
 #include <rendering/vector_rasterizer_cpu.hpp>
+#include <rendering/vector_raster_cache.hpp>
 #include <rendering/box_renderer.hpp>
 #include <rendering/textured_quad_renderer.hpp>
 #include <rendering/circular_arc_renderer.hpp>
 #include <rendering/bezier_renderer_gpu.hpp>
+#include <rendering/path_fill_renderer.hpp>
 #include <rendering/line_renderer.hpp>
 #include <rendering/renderer.hpp>
 
@@ -41,7 +46,9 @@
 #include <runtime.hpp>
 
 #include <widgets/box.hpp>
+#include <widgets/label.hpp>
 #include <widgets/text_box.hpp>
+#include <widgets/text_view.hpp>
 #include <widgets/grid.hpp>
 #include <widgets/vector_element.hpp>
 #include <widgets/vector_paths.hpp>
@@ -59,13 +66,18 @@ namespace WL
 	using PresentSurfaceDefault = PresentSurface<GPUAPIDefault>;
 	using FontRasterizerDefault = FontRasterizerCPU<GPUAPIDefault>;
 	using VectorRasterizerDefault = VectorRasterizerCPU<GPUAPIDefault>;
+	using VectorRasterCacheDefault = VectorRasterCache<VectorRasterizerDefault>;
 	
 	using FontRendererDefault = FontRenderer<PresentSurfaceDefault, FontRasterizerDefault>;
+	// Resolution independent alternative to the atlas based font renderer.
+	using FontRasterizerGPUDefault = FontRasterizerGPU<GPUAPIDefault>;
+	using FontRendererGPUDefault = FontRendererGPU<PresentSurfaceDefault, FontRasterizerGPUDefault>;
 	using BoxRendererDefault = BoxRenderer<PresentSurfaceDefault>;
 	using TexturedQuadRendererDefault = TexturedQuadRenderer<PresentSurfaceDefault>;
 	using LineRendererDefault = LineRenderer<PresentSurfaceDefault>;
 	using ArcRendererDefault = CircularArcRenderer<PresentSurfaceDefault>;
 	using BezierRendererDefault = BezierRendererGPU<PresentSurfaceDefault>;
+	using PathFillRendererDefault = PathFillRenderer<PresentSurfaceDefault>;
 
 	struct RenderersDefault
 	{
@@ -75,9 +87,20 @@ namespace WL
 		using LineRenderer = LineRendererDefault;
 		using ArcRenderer = ArcRendererDefault;
 		using VectorRasterizer = VectorRasterizerDefault;
+		using VectorRasterCache = VectorRasterCacheDefault;
 		using BezierRenderer = BezierRendererDefault;
+		using PathFillRenderer = PathFillRendererDefault;
 	};
 
 	using RendererDefault = Renderer<RenderersDefault>;
 	using RuntimeDefault = Runtime<GPUAPIDefault, RendererDefault>;
+
+	// Text drawn from the glyph outlines, no atlas is built per height.
+	struct RenderersGPUText : RenderersDefault
+	{
+		using FontRenderer = FontRendererGPUDefault;
+	};
+
+	using RendererGPUText = Renderer<RenderersGPUText>;
+	using RuntimeGPUText = Runtime<GPUAPIDefault, RendererGPUText>;
 }
\ No newline at end of file
@@ -26,7 +26,10 @@
 #include <common/types.hpp>
 #include <common/error.hpp>
 
+#include <common/unicode.hpp>
+
 #include <rendering/font_renderer.hpp>
+#include <rendering/text_layout.hpp>
 
 #include "widget.hpp"
 
@@ -41,6 +44,10 @@ namespace WL
 		F32 offsetY;
 		F32 fontHeight;
 		U16 fontIndex;
+		// Width to wrap the text at, 0 keeps each paragraph on one line.
+		F32 maxWidth = 0.f;
+		// Keeps the text crisp while it moves by fractions of a pixel.
+		B subpixelPositioning = false;
 	};
 
 	template <typename TRuntime>
@@ -50,7 +57,8 @@ namespace WL
 		using Base = Widget<TRuntime>;
 		using Runtime = TRuntime;
 		using GPUAPI = typename Runtime::GPUAPI;
-		using BoxDesc = QuadDesc2D<GPUAPI>;
+		using FontRenderer = typename Runtime::Renderer::FontRenderer;
+		using TextLayout = WL::TextLayout<typename FontRenderer::Rasterizer>;
 
 		Label(const LabelDesc& desc);
 
@@ -59,6 +67,16 @@ namespace WL
 		virtual auto GetBBox(const Widget<TRuntime>* w = nullptr) const->BBox override;
 
 		LabelDesc desc;
+
+	private:
+		// Lays the text out again only when the desc changed since the last call.
+		auto UpdateLayout() const -> V;
+		// Top left corner after relative positioning and centering.
+		auto GetPositionedOffset() const -> Vec2;
+
+		mutable Str laidOutText;
+		mutable Array<I32> codepoints;
+		mutable GlyphRun glyphRun;
 	};
 }
 
@@ -74,8 +92,49 @@ namespace WL
 	template<typename TRuntime>
 	inline auto Label<TRuntime>::AccumulateDrawState() const -> V
 	{
+		UpdateLayout();
+
+		auto offset = GetPositionedOffset();
+
 		FontRendererOptions renderDesc;
+		renderDesc.fontIndex = desc.fontIndex;
+		renderDesc.height = desc.fontHeight;
+		renderDesc.color = desc.color.operator Color4();
+		renderDesc.offsetX = offset[0];
+		renderDesc.offestY = offset[1];
+
+		FontRenderer::AccumulateGlyphRun(glyphRun, renderDesc);
+	}
+
+
+	template<typename TRuntime>
+	inline auto Label<TRuntime>::Update(const UpdateState& s) -> V
+	{
+		Base::Update(s);
+	}
+
+	template<typename TRuntime>
+	inline auto Label<TRuntime>::GetBBox(const Widget<TRuntime>* w) const -> BBox
+	{
+		UpdateLayout();
+
+		auto unitsPerPixel = Runtime::GPUPresentSurface::PixelsToUnits(1);
+		auto offset = GetPositionedOffset();
+		return BBox(
+			offset[0],
+			offset[1],
+			offset[0] + glyphRun.width * unitsPerPixel,
+			offset[1] + glyphRun.height * unitsPerPixel
+		);
+	}
+
+	template<typename TRuntime>
+	inline auto Label<TRuntime>::GetPositionedOffset() const -> Vec2
+	{
 		auto ar = Runtime::GPUPresentSurface::GetAspectRatio();
+		auto unitsPerPixel = Runtime::GPUPresentSurface::PixelsToUnits(1);
+		auto width = glyphRun.width * unitsPerPixel;
+		auto height = glyphRun.height * unitsPerPixel;
 
 		auto positionedOffsetX = desc.offsetX;
 		auto positionedOffsetY = desc.offsetY;
@@ -90,32 +149,37 @@ namespace WL
 
 			if (this->centered)
 			{
-				positionedOffsetX += (bBox.x1 - bBox.x0 - desc.width) / 2.f;
-				positionedOffsetY += (bBox.y1 - bBox.y0 - desc.height) / 2.f;
+				positionedOffsetX += (bBox.x1 - bBox.x0 - width) / 2.f;
+				positionedOffsetY += (bBox.y1 - bBox.y0 - height) / 2.f;
 			}
 		}
 		else if (this->centered)
 		{
-			// TODO:
+			positionedOffsetX = (1.f - width) / 2.f;
+			positionedOffsetY = (1.f / ar - height) / 2.f;
 		}
 
-		renderDesc.offsetY = -positionedOffsetY * ar * 2.f + 1.f - desc.height * ar;
-		renderDesc.offsetX = -1.f + positionedOffsetX * 2.f + renderDesc.width / 2.f;
-
-		//Runtime::Renderer::FontRenderer::AccumulateDrawState(codepoints, renderDesc);
+		return Vec2(positionedOffsetX, positionedOffsetY);
 	}
 
-
 	template<typename TRuntime>
-	inline auto Label<TRuntime>::Update(const UpdateState& s) -> V
+	inline auto Label<TRuntime>::UpdateLayout() const -> V
 	{
-		Base::Update(s);
-	}
+		if (desc.text != laidOutText)
+		{
+			laidOutText = desc.text;
+			codepoints.resize(laidOutText.size());
+			codepoints.resize(DecodeUTF8(Span<const Byte>((const Byte*)laidOutText.data(), laidOutText.size()), Span<I32>(codepoints)));
+		}
 
-	template<typename TRuntime>
-	inline auto Label<TRuntime>::GetBBox(const Widget<TRuntime>* w) const -> BBox
-	{
-		// TODO:
-		return BBox();
+		TextLayoutOptions options =
+		{
+			.fontIndex = desc.fontIndex,
+			.fontHeight = Runtime::GPUPresentSurface::UnitsToPixels(desc.fontHeight),
+			.maxWidth = F32(Runtime::GPUPresentSurface::UnitsToPixels(desc.maxWidth)),
+			.subpixelPositioning = desc.subpixelPositioning
+		};
+
+		TextLayout::Update(glyphRun, codepoints, options);
 	}
-}
\ No newline at end of file
+}
@@ -52,7 +52,9 @@ namespace WL::Particles
 		B alternatingUpdate;
 
 	protected:
-		Span<const Path2D> inPaths;
+		// Copied, the source widget rebuilds its paths when its level of
+		// detail changes and the traversals index into these.
+		Array<Path2D> inPaths;
 		Array<Traversal> traversals;
 		Array<F32> widths;
 		Array<Span<const Param>> params;
@@ -71,7 +73,8 @@ namespace WL::Particles
 		highlight({}, inPaths.width, inPaths.height, inPaths.offsetX, inPaths.offsetY),
 		alternatingUpdate(alternatingUpdate)
 	{
-		this->inPaths = inPaths.GetPaths();
+		auto sourcePaths = inPaths.GetPaths();
+		this->inPaths.assign(sourcePaths.begin(), sourcePaths.end());
 		params.resize(this->inPaths.size());
 		for (auto i = 0u; i < this->inPaths.size(); ++i)
 		{
@@ -80,7 +83,7 @@ namespace WL::Particles
 			auto length = (sizes.size() > i) ? sizes[i][1] : 0.25f;
 			auto delay = (initialDelays.size() > i) ? initialDelays[i] : 0.f;
 			widths.emplace_back(width);
-			traversals.emplace_back(inPaths.paths[i], length, speed, delay);
+			traversals.emplace_back(this->inPaths[i], length, speed, delay);
 		}
 
 		if (alternatingUpdate)
@@ -109,39 +112,41 @@ namespace WL::Particles
 		for (auto i = startPath; i < startPath + updateCount; ++i)
 		{
 			params[i] = traversals[i].Update(s.dt);
-			this->paths[i].primitives.clear();
-			highlight.paths[i].primitives.clear();
+			this->paths[i].primitives.Clear();
+			highlight.paths[i].primitives.Clear();
 			if (!params[i].empty() && params[i][0].curveIdx != CInvalidIdx)
 			{
 				this->paths[i].outlineWidth = widths[i] / 8.f;
 				this->paths[i].outlined = true;
+				this->paths[i].segmented = true;
 				this->paths[i].outlineColor = 0x4affffff;
 				this->paths[i].outlineFeather = inPaths[i].outlineFeather * 1.5f;
 				this->paths[i].outlineFeatherBegin = -inPaths[i].outlineFeather * 0.9;
 
 				highlight.paths[i].outlineWidth = widths[i] / 16.f;
 				highlight.paths[i].outlined = true;
+				highlight.paths[i].segmented = true;
 				highlight.paths[i].outlineColor = 0xffffffff;
 				highlight.paths[i].outlineFeather = inPaths[i].outlineFeather / 2.0f;
 				highlight.paths[i].outlineFeatherBegin = -inPaths[i].outlineFeather * 0.7;
 
 				for (auto j = 0; j < params[i].size(); ++j)
 				{
-					auto& primVar = inPaths[i].primitives[params[i][j].curveIdx];
-					if (HoldsAlternative<Quadratic>(primVar))
-					{
-						auto& prim = Get<Quadratic>(primVar);
-						auto renderPrim = GetSlice(prim, params[i][j].t0, params[i][j].t1);
-						this->paths[i].primitives.emplace_back(renderPrim);
-						highlight.paths[i].primitives.emplace_back(renderPrim);
-					}
-					if (HoldsAlternative<Line>(primVar))
-					{
-						auto& prim = Get<Line>(primVar);
-						auto renderPrim = GetSlice(prim, params[i][j].t0, params[i][j].t1);
-						this->paths[i].primitives.emplace_back(renderPrim);
-						highlight.paths[i].primitives.emplace_back(renderPrim);
-					}
+					inPaths[i].primitives.Visit
+					(
+						params[i][j].curveIdx,
+						[&](const auto& prim) -> V
+						{
+							// Cubics are approximated by quadratics before
+							// they reach the traversal.
+							if constexpr (!CIsSame<decltype(prim), Cubic>)
+							{
+								auto renderPrim = GetSlice(prim, params[i][j].t0, params[i][j].t1);
+								this->paths[i].primitives.Add(renderPrim);
+								highlight.paths[i].primitives.Add(renderPrim);
+							}
+						}
+					);
 				}
 			}
 			else if (!params[i].empty())
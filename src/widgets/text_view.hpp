@@ -0,0 +1,435 @@
+// MIT License
+// 
+// Copyright (c) 2024 Mihail Mladenov
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <common/types.hpp>
+#include <common/error.hpp>
+
+#include <common/unicode.hpp>
+
+#include <algebra/arithmetic.hpp>
+
+#include <rendering/font_renderer.hpp>
+#include <rendering/text_layout.hpp>
+
+#include "widget.hpp"
+
+
+namespace WL
+{
+	struct TextViewDesc
+	{
+		ColorU32 color;
+		F32 offsetX;
+		F32 offsetY;
+		// Size of the viewport, lines aren't wrapped and glyphs past the
+		// width are dropped.
+		F32 width;
+		F32 height;
+		F32 fontHeight;
+		U16 fontIndex;
+		// Lines kept laid out above and below the visible ones.
+		U32 overscanLines = 32;
+		// Keeps the last line in view while lines are appended, unless
+		// scrolled away from it.
+		B followTail = true;
+		// Keeps the text crisp while it moves by fractions of a pixel.
+		B subpixelPositioning = false;
+	};
+
+	// Scrollable view over a text with any number of lines. Only the
+	// visible lines and the overscan are laid out, so the cost per frame
+	// depends on the viewport and not on the text.
+	template <typename TRuntime>
+	class TextView : public Widget<TRuntime>
+	{
+	public:
+		using Base = Widget<TRuntime>;
+		using Runtime = TRuntime;
+		using GPUAPI = typename Runtime::GPUAPI;
+		using FontRenderer = typename Runtime::Renderer::FontRenderer;
+		using Rasterizer = typename FontRenderer::Rasterizer;
+		using TextLayout = WL::TextLayout<Rasterizer>;
+
+		// Lines scrolled per wheel step.
+		static constexpr U32 CWheelLines = 3;
+
+		TextView(const TextViewDesc& desc);
+
+		// Text without a trailing newline continues on the next append.
+		auto Append(StrView text) -> V;
+		auto AppendLine(StrView line) -> V;
+		auto Clear() -> V;
+
+		auto GetLineCount() const -> U64;
+		auto GetLine(U64 line) const -> StrView;
+		auto GetFirstVisibleLine() const -> U64;
+		auto GetVisibleLineCount() const -> U32;
+		auto ScrollToLine(U64 line) -> V;
+		auto ScrollBy(I64 lines) -> V;
+		auto ScrollToEnd() -> V;
+		auto IsAtEnd() const -> B;
+
+		virtual auto AccumulateDrawState() const->V override;
+		virtual auto Update(const UpdateState& s) -> V override;
+		virtual auto GetBBox(const Widget<TRuntime>* w = nullptr) const->BBox override;
+
+		TextViewDesc desc;
+
+	private:
+		static constexpr U32 CChunkLineCount = 4096;
+		static constexpr U64 CNoLine = ~0ull;
+
+		// Lines are stored back to back, every chunk but the last one is
+		// full so the chunk of a line is found by division.
+		struct Chunk
+		{
+			Str text;
+			Array<U32> lineEnds;
+		};
+
+		struct LineRun
+		{
+			U64 line = CNoLine;
+			GlyphRun run;
+		};
+
+		auto StartLine() -> V;
+		auto AppendToLastLine(StrView text) -> V;
+		auto GetLayoutOptions() const -> TextLayoutOptions;
+		auto GetLineHeight() const -> F32;
+		auto GetOrigin() const -> Vec2;
+		// Moves the window of laid out lines over the visible ones, reusing
+		// the runs of lines which stay in it.
+		auto UpdateWindow() const -> V;
+
+		Array<Chunk> chunks;
+		U64 lineCount = 0;
+		B lastLineOpen = false;
+		U64 firstLine = 0;
+
+		mutable Array<LineRun> window;
+		mutable U64 windowFirstLine = 0;
+		mutable TextLayoutOptions windowOptions;
+		mutable F32 windowWidth = 0.f;
+	};
+}
+
+
+namespace WL
+{
+	template<typename TRuntime>
+	TextView<TRuntime>::TextView(const TextViewDesc& desc)
+		: desc(desc)
+	{
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::Append(StrView text) -> V
+	{
+		auto followTail = desc.followTail && IsAtEnd();
+
+		while (!text.empty())
+		{
+			auto newLine = text.find('\n');
+			auto segment = text.substr(0, newLine);
+			if (newLine != StrView::npos && !segment.empty() && segment.back() == '\r')
+			{
+				segment.remove_suffix(1);
+			}
+
+			if (!lastLineOpen)
+			{
+				StartLine();
+			}
+			AppendToLastLine(segment);
+
+			lastLineOpen = newLine == StrView::npos;
+			if (lastLineOpen)
+			{
+				break;
+			}
+			text.remove_prefix(newLine + 1);
+		}
+
+		if (followTail)
+		{
+			ScrollToEnd();
+		}
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::AppendLine(StrView line) -> V
+	{
+		Append(line);
+		Append("\n");
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::Clear() -> V
+	{
+		chunks.clear();
+		lineCount = 0;
+		lastLineOpen = false;
+		firstLine = 0;
+		window.clear();
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetLineCount() const -> U64
+	{
+		return lineCount;
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetLine(U64 line) const -> StrView
+	{
+		WL_ASSERT(line < lineCount);
+
+		auto& chunk = chunks[line / CChunkLineCount];
+		auto index = line % CChunkLineCount;
+		auto begin = index? chunk.lineEnds[index - 1] : 0u;
+		return StrView(chunk.text).substr(begin, chunk.lineEnds[index] - begin);
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetFirstVisibleLine() const -> U64
+	{
+		return firstLine;
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetVisibleLineCount() const -> U32
+	{
+		auto height = Runtime::GPUPresentSurface::UnitsToPixels(desc.height);
+		return Max(1u, U32(height / GetLineHeight()));
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::ScrollToLine(U64 line) -> V
+	{
+		auto visibleLines = GetVisibleLineCount();
+		auto lastFirstLine = lineCount > visibleLines? lineCount - visibleLines : 0;
+		firstLine = Min(line, lastFirstLine);
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::ScrollBy(I64 lines) -> V
+	{
+		if (lines < 0 && U64(-lines) > firstLine)
+		{
+			ScrollToLine(0);
+		}
+		else
+		{
+			ScrollToLine(firstLine + lines);
+		}
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::ScrollToEnd() -> V
+	{
+		ScrollToLine(CNoLine);
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::IsAtEnd() const -> B
+	{
+		return firstLine + GetVisibleLineCount() >= lineCount;
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::AccumulateDrawState() const -> V
+	{
+		UpdateWindow();
+
+		auto origin = GetOrigin();
+		auto lineHeight = Runtime::GPUPresentSurface::PixelsToUnits(1) * GetLineHeight();
+		auto lastLine = Min(lineCount, firstLine + GetVisibleLineCount());
+
+		FontRendererOptions renderDesc;
+		renderDesc.fontIndex = desc.fontIndex;
+		renderDesc.height = desc.fontHeight;
+		renderDesc.color = desc.color.operator Color4();
+		renderDesc.offsetX = origin[0];
+
+		for (auto line = firstLine; line < lastLine; ++line)
+		{
+			renderDesc.offestY = origin[1] + (line - firstLine) * lineHeight;
+			FontRenderer::AccumulateGlyphRun(window[line - windowFirstLine].run, renderDesc);
+		}
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::Update(const UpdateState& s) -> V
+	{
+		Base::Update(s);
+
+		if (s.wheelY != 0.f && GetBBox().Contains(Vec2(s.mouseX, s.mouseY)))
+		{
+			ScrollBy(-I64(s.wheelY * CWheelLines));
+		}
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetBBox(const Widget<TRuntime>* w) const -> BBox
+	{
+		auto origin = GetOrigin();
+		return BBox(origin[0], origin[1], origin[0] + desc.width, origin[1] + desc.height);
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::StartLine() -> V
+	{
+		if (chunks.empty() || chunks.back().lineEnds.size() == CChunkLineCount)
+		{
+			chunks.emplace_back();
+		}
+
+		auto& chunk = chunks.back();
+		chunk.lineEnds.push_back(chunk.text.size());
+		lineCount++;
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::AppendToLastLine(StrView text) -> V
+	{
+		auto& chunk = chunks.back();
+		chunk.text.append(text);
+		chunk.lineEnds.back() = chunk.text.size();
+
+		// The last line may already be laid out with less text.
+		auto line = lineCount - 1;
+		if (line >= windowFirstLine && line < windowFirstLine + window.size())
+		{
+			window[line - windowFirstLine].line = CNoLine;
+		}
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetLayoutOptions() const -> TextLayoutOptions
+	{
+		return
+		{
+			.fontIndex = desc.fontIndex,
+			.fontHeight = Runtime::GPUPresentSurface::UnitsToPixels(desc.fontHeight),
+			.subpixelPositioning = desc.subpixelPositioning
+		};
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetLineHeight() const -> F32
+	{
+		auto fontHeight = Runtime::GPUPresentSurface::UnitsToPixels(desc.fontHeight);
+		return Max(1.f, Rasterizer::GetLineHeight(desc.fontIndex) * fontHeight);
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::GetOrigin() const -> Vec2
+	{
+		auto origin = Vec2(desc.offsetX, desc.offsetY);
+
+		if (this->relativelyPositioned)
+		{
+			WL_ASSERT(this->ancestor);
+			auto bBox = this->ancestor->GetBBox(this);
+
+			origin[0] += bBox.x0;
+			origin[1] += bBox.y0;
+
+			if (this->centered)
+			{
+				origin[0] += (bBox.x1 - bBox.x0 - desc.width) / 2.f;
+				origin[1] += (bBox.y1 - bBox.y0 - desc.height) / 2.f;
+			}
+		}
+		else if (this->centered)
+		{
+			auto ar = Runtime::GPUPresentSurface::GetAspectRatio();
+			origin[0] = (1.f - desc.width) / 2.f;
+			origin[1] = (1.f / ar - desc.height) / 2.f;
+		}
+
+		return origin;
+	}
+
+	template<typename TRuntime>
+	inline auto TextView<TRuntime>::UpdateWindow() const -> V
+	{
+		auto options = GetLayoutOptions();
+		auto width = F32(Runtime::GPUPresentSurface::UnitsToPixels(desc.width));
+		if (options != windowOptions || width != windowWidth)
+		{
+			window.clear();
+			windowOptions = options;
+			windowWidth = width;
+		}
+
+		auto begin = firstLine > desc.overscanLines? firstLine - desc.overscanLines : 0;
+		auto end = Min(lineCount, firstLine + GetVisibleLineCount() + desc.overscanLines);
+
+		if (begin != windowFirstLine || end - begin != window.size())
+		{
+			Array<LineRun> newWindow(end - begin);
+			for (auto line = Max(begin, windowFirstLine); line < Min(end, windowFirstLine + window.size()); ++line)
+			{
+				newWindow[line - begin] = std::move(window[line - windowFirstLine]);
+			}
+
+			window = std::move(newWindow);
+			windowFirstLine = begin;
+		}
+
+		for (auto i = 0u; i < window.size(); ++i)
+		{
+			auto& lineRun = window[i];
+			auto line = windowFirstLine + i;
+			if (lineRun.line == line)
+			{
+				continue;
+			}
+
+			// The runs keep their storage between lines.
+			auto text = GetLine(line);
+			auto& run = lineRun.run;
+			run.codepoints.resize(text.size());
+			run.codepoints.resize(DecodeUTF8(Span<const Byte>((const Byte*)text.data(), text.size()), Span<I32>(run.codepoints)));
+			run.options = options;
+			TextLayout::Layout(run);
+
+			if (width > 0.f)
+			{
+				auto& glyphs = run.glyphs;
+				auto visibleGlyphs = 0u;
+				while (visibleGlyphs < glyphs.size() && glyphs[visibleGlyphs].x + glyphs[visibleGlyphs].xAdvance <= width)
+				{
+					visibleGlyphs++;
+				}
+				glyphs.resize(visibleGlyphs);
+			}
+
+			lineRun.line = line;
+		}
+	}
+}
@@ -32,6 +32,17 @@
 
 namespace WL
 {
+	// Drawn while the vector image is rasterized in the background, a flat
+	// color box unless an image is given.
+	template <typename TGPUAPI>
+	struct VectorPlaceholder
+	{
+		using Image = TGPUAPI::Image;
+
+		ColorU32 color = 0;
+		Image* image = nullptr;
+	};
+
 	template <typename TRuntime>
 	class VectorElement : public Box<TRuntime>
 	{
@@ -42,17 +53,31 @@ namespace WL
 		using Image = GPUAPI::Image;
 		using BoxDesc = Base::BoxDesc;
 		using Path2D = Path2D<F32>;
+		using RasterCache = Runtime::Renderer::VectorRasterCache;
+		using Placeholder = VectorPlaceholder<GPUAPI>;
 
-		VectorElement(Span<const Path2D> paths, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource = true);
-		VectorElement(StrView svg, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource = true);
+		// Asynchronous elements show the placeholder until the source is
+		// rasterized on the thread pool, or over the next frames when there
+		// are no worker threads. The others rasterize it on the spot.
+		VectorElement(Span<const Path2D> paths, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource = true, B async = true, const Placeholder& placeholder = {});
+		VectorElement(StrView svg, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource = true, B async = true, const Placeholder& placeholder = {});
+		~VectorElement();
 
 		virtual auto Update(const UpdateState& s) -> V override;
 	private:
-		Map<U32, Image*> rasterizedCache;
+		auto InitDesc(F32 width, F32 height, F32 offsetX, F32 offsetY) -> V;
+		// Picks up the image matching the current pixel size, or requests it
+		// and shows the closest one meanwhile.
+		auto Refresh() -> V;
+		auto SetImage(Image* newImage) -> V;
+
 		Array<Path2D> paths;
 		Span<const Path2D> pathsView;
 		Str svg;
 		StrView svgView;
+		U64 sourceKey;
+		Image* image = nullptr;
+		Placeholder placeholder;
 	};
 }
 
@@ -60,28 +85,10 @@ namespace WL
 namespace WL
 {
 	template<typename TRuntime>
-	VectorElement<TRuntime>::VectorElement(Span<const Path2D> paths, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource) :
-		Base(BoxDesc())
+	VectorElement<TRuntime>::VectorElement(Span<const Path2D> paths, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource, B async, const Placeholder& placeholder) :
+		Base(BoxDesc()), placeholder(placeholder)
 	{
-		this->desc.width = width;
-		this->desc.height = height;
-		this->desc.offsetX = offsetX;
-		this->desc.offsetY = offsetY;
-		this->desc.u0 = 0;
-		this->desc.v0 = 0;
-		this->desc.u1 = 1;
-		this->desc.v1 = 1;
-		this->desc.textured = true;
-		
-		auto pxWidth = Runtime::GPUPresentSurface::UnitsToPixels(width);
-		auto pxHeight = Runtime::GPUPresentSurface::UnitsToPixels(height);
-
-		// TODO: Cleanup in destructor.
-		auto img = new Image;
-		rasterizedCache[pxWidth] = img;
-		img->Allocate(EFormat::BGRA8, pxWidth, pxHeight);
-		Runtime::Renderer::VectorRasterizer::RasterizeToImage(paths, img);
-		this->desc.texture = img;
+		InitDesc(width, height, offsetX, offsetY);
 
 		if (copySource)
 		{
@@ -93,32 +100,26 @@ namespace WL
 			pathsView = paths;
 		}
 
-	}
-
+		sourceKey = RasterCache::HashSource(pathsView);
+		SetImage(nullptr);
 
-	template<typename TRuntime>
-	inline VectorElement<TRuntime>::VectorElement(StrView svg, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource) :
-		Base(BoxDesc())
-	{
-		this->desc.width = width;
-		this->desc.height = height;
-		this->desc.offsetX = offsetX;
-		this->desc.offsetY = offsetY;
-		this->desc.u0 = 0;
-		this->desc.v0 = 0;
-		this->desc.u1 = 1;
-		this->desc.v1 = 1;
-		this->desc.textured = true;
+		if (async)
+		{
+			Refresh();
+			return;
+		}
 
 		auto pxWidth = Runtime::GPUPresentSurface::UnitsToPixels(width);
 		auto pxHeight = Runtime::GPUPresentSurface::UnitsToPixels(height);
+		SetImage(RasterCache::Acquire(pathsView, sourceKey, pxWidth, pxHeight));
+	}
+
 
-		// TODO: Cleanup in destructor.
-		auto img = new Image;
-		rasterizedCache[pxWidth] = img;
-		img->Allocate(EFormat::BGRA8, pxWidth, pxHeight);
-		Runtime::Renderer::VectorRasterizer::RasterizeToImage(svg, img);
-		this->desc.texture = img;
+	template<typename TRuntime>
+	inline VectorElement<TRuntime>::VectorElement(StrView svg, F32 width, F32 height, F32 offsetX, F32 offsetY, B copySource, B async, const Placeholder& placeholder) :
+		Base(BoxDesc()), placeholder(placeholder)
+	{
+		InitDesc(width, height, offsetX, offsetY);
 
 		if (copySource)
 		{
@@ -129,6 +130,26 @@ namespace WL
 		{
 			svgView = svg;
 		}
+
+		sourceKey = RasterCache::HashSource(svgView);
+		SetImage(nullptr);
+
+		if (async)
+		{
+			Refresh();
+			return;
+		}
+
+		auto pxWidth = Runtime::GPUPresentSurface::UnitsToPixels(width);
+		auto pxHeight = Runtime::GPUPresentSurface::UnitsToPixels(height);
+		SetImage(RasterCache::Acquire(svgView, sourceKey, pxWidth, pxHeight));
+	}
+
+
+	template<typename TRuntime>
+	inline VectorElement<TRuntime>::~VectorElement()
+	{
+		SetImage(nullptr);
 	}
 
 
@@ -136,5 +157,73 @@ namespace WL
 	inline auto VectorElement<TRuntime>::Update(const UpdateState& s) -> V
 	{
 		Base::Update(s);
+		Refresh();
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorElement<TRuntime>::Refresh() -> V
+	{
+		auto pxWidth = Runtime::GPUPresentSurface::UnitsToPixels(this->desc.width);
+		auto pxHeight = Runtime::GPUPresentSurface::UnitsToPixels(this->desc.height);
+		if (image && image->width == pxWidth && image->height == pxHeight)
+		{
+			return;
+		}
+
+		if (auto exact = RasterCache::TryAcquire(sourceKey, pxWidth, pxHeight))
+		{
+			SetImage(exact);
+			return;
+		}
+
+		if (RasterCache::IsPending(sourceKey, pxWidth, pxHeight))
+		{
+			return;
+		}
+
+		// The closest cached size is stretched until the exact one is ready.
+		if (svgView.empty())
+		{
+			RasterCache::RasterizeAsync(pathsView, sourceKey, pxWidth, pxHeight);
+		}
+		else
+		{
+			RasterCache::RasterizeAsync(svgView, sourceKey, pxWidth, pxHeight);
+		}
+
+		if (auto nearest = RasterCache::AcquireNearest(sourceKey, pxWidth, pxHeight))
+		{
+			SetImage(nearest);
+		}
 	}
-}
\ No newline at end of file
+
+
+	template<typename TRuntime>
+	inline auto VectorElement<TRuntime>::InitDesc(F32 width, F32 height, F32 offsetX, F32 offsetY) -> V
+	{
+		this->desc.width = width;
+		this->desc.height = height;
+		this->desc.offsetX = offsetX;
+		this->desc.offsetY = offsetY;
+		this->desc.u0 = 0;
+		this->desc.v0 = 0;
+		this->desc.u1 = 1;
+		this->desc.v1 = 1;
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorElement<TRuntime>::SetImage(Image* newImage) -> V
+	{
+		if (image)
+		{
+			RasterCache::Release(image);
+		}
+
+		image = newImage;
+		this->desc.texture = image? image : placeholder.image;
+		this->desc.textured = this->desc.texture != nullptr;
+		this->desc.color = placeholder.color;
+	}
+}
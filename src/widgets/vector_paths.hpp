@@ -23,9 +23,13 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <common/error.hpp>
+#include <common/thread_pool.hpp>
 
 #include "rendering/vector_path.hpp"
+#include "rendering/path_fill_renderer.hpp"
 
 #include "widget.hpp"
 
@@ -44,6 +48,7 @@ namespace WL
 		using Line = Path2D::Line;
 		using Cubic = Path2D::CubicBezier;
 		using Quadratic = Path2D::QuadraticBezier;
+		using PathFillRenderer = typename Runtime::Renderer::PathFillRenderer;
 
 		VectorPaths(Span<const Path2D> paths, F32 width, F32 height, F32 offsetX, F32 offsetY);
 
@@ -51,14 +56,69 @@ namespace WL
 		virtual auto GetBBox(const Widget<TRuntime>* w = nullptr) const -> BBox override;
 		virtual auto Update(const UpdateState& s) -> V override;
 
+		// Maximal distance in pixels between a cubic and its quadratics.
+		static constexpr F32 CTolerancePixels = 0.25f;
+		static constexpr U32 CMaxDetailLevels = 4;
+
 		auto UpdatePaths(Span<const Path2D> paths) -> V;
 		auto GetPaths() const -> Span<const Path2D>;
 
+		// The drawn paths in WL coordinates, rebuilt when the detail level
+		// or the placement changes.
 		Array<Path2D> paths;
+		// Per path, empty for the ones which aren't filled.
+		Array<PathFill> fills;
 		F32 width;
 		F32 height;
 		F32 offsetX;
 		F32 offsetY;
+
+	private:
+		// Source paths with the cubics approximated for one power of two
+		// on-screen size, in normalized coordinates so it's reused as the
+		// placement changes.
+		using DetailLevel = Array<Path2D>;
+
+		struct DetailLevelBuild
+		{
+			U32 level;
+			DetailLevel result;
+			std::atomic<B> done = false;
+		};
+
+		// Level L fits on-screen sizes up to 2^L pixels.
+		auto GetDetailLevel() const -> U32;
+		static auto BuildDetailLevel(Span<const Path2D> sources, U32 level) -> DetailLevel;
+		auto RequestDetailLevel(U32 level) -> V;
+		auto ShowDetailLevel(U32 level) -> V;
+		auto TrimDetailLevels() -> V;
+		// Closes every contour of the transformed path, a contour ends where
+		// the next primitive doesn't start at the end of the previous one.
+		auto BuildFill(const Path2D& path) const -> PathFill;
+
+		// Endpoints of a primitive with the control points next to them,
+		// which give the tangents of the joins.
+		struct StrokeEnds
+		{
+			Vec2 begin;
+			Vec2 beginAdjacent;
+			Vec2 end;
+			Vec2 endAdjacent;
+			// Of the control polygon, spreads the taper along the path.
+			F32 length = 0.f;
+		};
+
+		static auto GetStrokeEnds(const Path2D& path, U32 i) -> StrokeEnds;
+		static auto Coincide(Vec2 p0, Vec2 p1) -> B;
+		auto AccumulateJoinedStroke(const Path2D& path) const -> V;
+		auto AccumulateSegmentedStroke(const Path2D& path) const -> V;
+
+		// Shared with the builds still running when the paths are replaced.
+		SharedPtr<const Array<Path2D>> sources;
+		Map<U32, DetailLevel> detailLevels;
+		Array<SharedPtr<DetailLevelBuild>> builds;
+		U32 shownLevel = 0;
+		Vec4 shownPlacement;
 	};
 }
 
@@ -76,38 +136,199 @@ namespace WL
 	template<typename TRuntime>
 	inline auto VectorPaths<TRuntime>::UpdatePaths(Span<const Path2D> paths) -> V
 	{
+		sources = MakeShared<const Array<Path2D>>(paths.begin(), paths.end());
+		detailLevels.clear();
+		builds.clear();
+
+		auto level = GetDetailLevel();
+		detailLevels[level] = BuildDetailLevel(*sources, level);
+		ShowDetailLevel(level);
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::GetDetailLevel() const -> U32
+	{
+		auto pixels = TRuntime::PresentSurface::GetDimensions()[0] * Max(width, height);
+		return std::bit_width(Max(U32(Ceil(pixels)), 1u) - 1u);
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::BuildDetailLevel(Span<const Path2D> sources, U32 level) -> DetailLevel
+	{
+		// Normalized coordinates span at most 2^level pixels on screen.
+		auto tolerance = CTolerancePixels / F32(1u << level);
+
+		DetailLevel result;
+		result.reserve(sources.size());
+
+		// Reused across paths, the cubics of a path are approximated in one
+		// batch.
+		Array<U32> quadraticCounts;
+		Array<Quadratic> quadratics;
+		for (auto& path : sources)
+		{
+			result.emplace_back(path.CloneWithoutPrimitives());
+
+			auto cubics = path.primitives.GetCubics();
+			quadraticCounts.resize(cubics.size());
+			quadratics.resize(GetQuadraticApproximationCounts<F32>(cubics, tolerance, quadraticCounts));
+			ApproximateByQuadratics<F32>(cubics, quadraticCounts, quadratics);
+
+			auto& primitives = result.back().primitives;
+			primitives.Reserve(path.primitives.GetSize() - cubics.size() + quadratics.size());
+
+			auto cubic = 0u;
+			auto quadratic = 0u;
+			path.primitives.ForEach
+			(
+				[&](const auto& primitive) -> V
+				{
+					if constexpr (CIsSame<decltype(primitive), Cubic>)
+					{
+						for (auto end = quadratic + quadraticCounts[cubic++]; quadratic < end; ++quadratic)
+						{
+							primitives.Add(quadratics[quadratic]);
+						}
+					}
+					else
+					{
+						primitives.Add(primitive);
+					}
+				}
+			);
+		}
+
+		return result;
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::RequestDetailLevel(U32 level) -> V
+	{
+		for (auto& build : builds)
+		{
+			if (build->level == level)
+			{
+				return;
+			}
+		}
+
+		auto build = MakeShared<DetailLevelBuild>();
+		build->level = level;
+		builds.push_back(build);
+
+		GetThreadPool().Submit(
+			[build, sources = sources]()
+			{
+				build->result = BuildDetailLevel(*sources, build->level);
+				build->done = true;
+			}
+		);
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::ShowDetailLevel(U32 level) -> V
+	{
+		shownLevel = level;
+		shownPlacement = Vec4(width, height, offsetX, offsetY);
+
 		this->paths.clear();
-		for (auto& path : paths)
+		fills.clear();
+		for (auto& path : detailLevels[level])
 		{
-			auto tolerance = 28.f / (TRuntime::PresentSurface::GetDimensions()[0] * width);
 			this->paths.emplace_back(path.CloneWithoutPrimitives());
-			for (auto& primitive : path.primitives)
+
+			auto& primitives = this->paths.back().primitives;
+			primitives.Reserve(path.primitives.GetSize());
+			path.primitives.ForEach
+			(
+				[&](const auto& primitive) -> V
+				{
+					primitives.Add(TRuntime::PresentSurface::NormalizedImageToWLCoords(primitive, width, height, offsetX, offsetY));
+				}
+			);
+
+			fills.push_back(path.filled? BuildFill(this->paths.back()) : PathFill());
+		}
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::TrimDetailLevels() -> V
+	{
+		// The levels farthest from the shown one go first.
+		auto distance = [&](U32 level) { return level > shownLevel? level - shownLevel : shownLevel - level; };
+		while (detailLevels.size() > CMaxDetailLevels)
+		{
+			auto farthest = detailLevels.begin();
+			for (auto it = detailLevels.begin(); it != detailLevels.end(); ++it)
 			{
-				if (HoldsAlternative<Line>(primitive) || HoldsAlternative<Quadratic>(primitive))
+				if (distance(it->first) > distance(farthest->first))
 				{
-					Visit<V>
-					(
-						[&](const auto& prim) -> V
-						{
-							auto transformed = TRuntime::PresentSurface::NormalizedImageToWLCoords(prim, width, height, offsetX, offsetY);
-							this->paths.back().primitives.emplace_back(transformed);
-						},
-						primitive
-					);
+					farthest = it;
+				}
+			}
+			detailLevels.erase(farthest);
+		}
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::BuildFill(const Path2D& path) const -> PathFill
+	{
+		Array<Quadratic> curves;
+		curves.reserve(path.primitives.GetSize() + 1);
+
+		auto addLine = [&](Vec2 p0, Vec2 p1)
+		{
+			curves.emplace_back(p0, (p0 + p1) * 0.5f, p1);
+		};
+
+		Vec2 contourStart;
+		Vec2 contourEnd;
+		path.primitives.ForEach
+		(
+			[&](const auto& primitive) -> V
+			{
+				auto start = primitive.points.front();
+				auto end = primitive.points.back();
+
+				if (curves.empty())
+				{
+					contourStart = start;
+				}
+				else if (!Coincide(start, contourEnd))
+				{
+					addLine(contourEnd, contourStart);
+					contourStart = start;
+				}
+
+				if constexpr (CIsSame<decltype(primitive), Line>)
+				{
+					addLine(start, end);
+				}
+				else if constexpr (CIsSame<decltype(primitive), Quadratic>)
+				{
+					curves.push_back(primitive);
 				}
 				else
 				{
-					WL_ASSERT(HoldsAlternative<Cubic>(primitive));
-					auto& cubic = Get<Cubic>(primitive);
-					auto transformedCubic = TRuntime::PresentSurface::NormalizedImageToWLCoords(cubic, width, height, offsetX, offsetY);
-					auto approxQuadratics = ApproximateByQuadratics(transformedCubic, tolerance);
-					for (auto& curve : approxQuadratics)
-					{
-						this->paths.back().primitives.emplace_back(curve);
-					}
+					// Cubics are approximated by quadratics in UpdatePaths.
+					WL_ASSERT(false);
 				}
+				contourEnd = end;
 			}
+		);
+
+		if (!curves.empty() && !Coincide(contourEnd, contourStart))
+		{
+			addLine(contourEnd, contourStart);
 		}
+
+		return PathFillRenderer::BuildFill(curves);
 	}
 
 
@@ -121,18 +342,148 @@ namespace WL
 	template<typename TRuntime>
 	inline auto VectorPaths<TRuntime>::AccumulateDrawState() const -> V
 	{
+		for (auto i = 0u; i < paths.size(); ++i)
+		{
+			if (paths[i].filled && paths[i].fillColor.a)
+			{
+				PathFillRenderer::AccumulateFill(fills[i], paths[i].fillColor);
+			}
+		}
+
 		for (auto& path : paths)
 		{
-			for (auto i = 0u; i < path.primitives.size(); ++i)
+			if (path.segmented)
+			{
+				AccumulateSegmentedStroke(path);
+			}
+			else
+			{
+				AccumulateJoinedStroke(path);
+			}
+		}
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::AccumulateJoinedStroke(const Path2D& path) const -> V
+	{
+		auto count = path.primitives.GetSize();
+		if (!count)
+		{
+			return;
+		}
+
+		// Closed paths get a line back to the start when they don't end there,
+		// like close_path in the CPU rasterizer. It's stroked after the last
+		// primitive as if it were one more.
+		auto first = GetStrokeEnds(path, 0);
+		auto last = GetStrokeEnds(path, count - 1);
+		Line closingLine(last.end, first.begin);
+		StrokeEnds closingEnds =
+		{
+			.begin = last.end,
+			.beginAdjacent = first.begin,
+			.end = first.begin,
+			.endAdjacent = last.end,
+			.length = Distance(last.end, first.begin)
+		};
+		auto segmentCount = count + U32(path.closed && !Coincide(last.end, first.begin));
+		auto getEnds = [&](U32 i) { return i < count? GetStrokeEnds(path, i) : closingEnds; };
+
+		auto tapered = path.widthBegin != 0.f || path.widthEnd != 0.f;
+		auto totalLength = 0.f;
+		if (tapered)
+		{
+			for (auto i = 0u; i < segmentCount; ++i)
+			{
+				totalLength += getEnds(i).length;
+			}
+			totalLength = Max(totalLength, 1e-6f);
+		}
+
+		StrokeSegment stroke;
+		stroke.color = path.outlineColor;
+		stroke.widthBegin = path.outlineWidth;
+		stroke.widthEnd = path.outlineWidth;
+		stroke.feather = path.outlineFeather;
+		stroke.miterLimit = path.miterLimit;
+		stroke.join = path.join;
+		stroke.cap = path.cap;
+
+		auto accumulate = [&](const auto& primitive) -> V
+		{
+			auto renderPrimitive = Runtime::PresentSurface::WLToRenderCoords(primitive);
+
+			if constexpr (CIsSame<decltype(primitive), Line>)
+			{
+				Runtime::Renderer::LineRenderer::AccumulateLine(renderPrimitive, stroke);
+			}
+			else if constexpr (CIsSame<decltype(primitive), Quadratic>)
+			{
+				Runtime::Renderer::BezierRenderer::AccumulateBezier(renderPrimitive, stroke);
+			}
+			else
+			{
+				WL_ASSERT(false);
+			}
+		};
+
+		// A closed contour joins its last segment to the first one.
+		auto previous = getEnds(segmentCount - 1);
+		auto current = first;
+		auto hasPrevious = segmentCount > 1 && Coincide(previous.end, first.begin);
+		auto closed = hasPrevious;
+		auto distance = 0.f;
+
+		for (auto i = 0u; i < segmentCount; ++i)
+		{
+			auto next = (i + 1 < segmentCount)? getEnds(i + 1) : first;
+			auto hasNext = (i + 1 < segmentCount)? Coincide(current.end, next.begin) : closed;
+
+			// Zero length neighbours have no tangent, the end gets a cap.
+			stroke.hasPrevious = hasPrevious && !Coincide(previous.endAdjacent, current.begin);
+			stroke.hasNext = hasNext && !Coincide(next.beginAdjacent, current.end);
+			stroke.previous = Runtime::PresentSurface::WLToRenderCoords(previous.endAdjacent);
+			stroke.next = Runtime::PresentSurface::WLToRenderCoords(next.beginAdjacent);
+
+			if (tapered)
+			{
+				stroke.widthBegin = Lerp(path.widthBegin, path.widthEnd, distance / totalLength);
+				distance += current.length;
+				stroke.widthEnd = Lerp(path.widthBegin, path.widthEnd, distance / totalLength);
+			}
+
+			if (i < count)
+			{
+				path.primitives.Visit(i, accumulate);
+			}
+			else
+			{
+				accumulate(closingLine);
+			}
+
+			previous = current;
+			current = next;
+			hasPrevious = hasNext;
+		}
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::AccumulateSegmentedStroke(const Path2D& path) const -> V
+	{
+		auto i = 0u;
+		path.primitives.ForEach
+		(
+			[&](const auto& primitive) -> V
 			{
-				auto& primitive = path.primitives[i];
 				auto featherBegin = (i == 0) ? path.outlineFeatherBegin : 0;
-				auto featherEnd = (i == path.primitives.size() - 1) ? path.outlineFeatherEnd : 0;
+				auto featherEnd = (i == path.primitives.GetSize() - 1) ? path.outlineFeatherEnd : 0;
+				i++;
 
-				if (HoldsAlternative<Line>(primitive))
+				if constexpr (CIsSame<decltype(primitive), Line>)
 				{
-					auto& line = Get<Line>(primitive);
-					auto renderLine = Runtime::PresentSurface::WLToRenderCoords(line);
+					auto renderLine = Runtime::PresentSurface::WLToRenderCoords(primitive);
 
 					Runtime::Renderer::LineRenderer::AccumulateLine
 					(
@@ -144,11 +495,9 @@ namespace WL
 						featherEnd
 					);
 				}
-				else
+				else if constexpr (CIsSame<decltype(primitive), Quadratic>)
 				{
-					WL_ASSERT(HoldsAlternative<Quadratic>(primitive));
-					auto& curve = Get<Quadratic>(primitive);
-					auto renderCurve = Runtime::PresentSurface::WLToRenderCoords(curve);
+					auto renderCurve = Runtime::PresentSurface::WLToRenderCoords(primitive);
 
 					Runtime::Renderer::BezierRenderer::AccumulateBezier
 					(
@@ -160,14 +509,89 @@ namespace WL
 						featherEnd
 					);
 				}
+				else
+				{
+					WL_ASSERT(false);
+				}
 			}
-		}
+		);
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::GetStrokeEnds(const Path2D& path, U32 i) -> StrokeEnds
+	{
+		StrokeEnds ends;
+		path.primitives.Visit
+		(
+			i,
+			[&](const auto& primitive) -> V
+			{
+				auto& points = primitive.points;
+				auto last = points.size() - 1;
+
+				ends.begin = points[0];
+				ends.end = points[last];
+				// Degenerate quadratics take the tangent from the far end.
+				ends.beginAdjacent = Coincide(points[1], points[0]) ? points[last] : points[1];
+				ends.endAdjacent = Coincide(points[last - 1], points[last]) ? points[0] : points[last - 1];
+
+				for (auto j = 0u; j < last; ++j)
+				{
+					ends.length += Distance(points[j], points[j + 1]);
+				}
+			}
+		);
+		return ends;
+	}
+
+
+	template<typename TRuntime>
+	inline auto VectorPaths<TRuntime>::Coincide(Vec2 p0, Vec2 p1) -> B
+	{
+		// Far below a pixel, endpoints of approximated cubics may be off by
+		// rounding.
+		return Abs(p0[0] - p1[0]) + Abs(p0[1] - p1[1]) < 1e-6f;
 	}
 
 	template<typename TRuntime>
 	inline auto VectorPaths<TRuntime>::Update(const UpdateState& s) -> V
 	{
 		Base::Update(s);
+
+		// Paths assigned directly, as by the particle widgets, aren't managed.
+		if (!sources || sources->empty())
+		{
+			return;
+		}
+
+		for (auto i = 0u; i < builds.size();)
+		{
+			if (builds[i]->done)
+			{
+				detailLevels[builds[i]->level] = std::move(builds[i]->result);
+				builds.erase(builds.begin() + i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		// Until a missing level is built the shown one stays, placed anew
+		// if it moved.
+		auto level = GetDetailLevel();
+		if (!detailLevels.contains(level))
+		{
+			RequestDetailLevel(level);
+			level = shownLevel;
+		}
+
+		if (level != shownLevel || !(shownPlacement == Vec4(width, height, offsetX, offsetY)))
+		{
+			ShowDetailLevel(level);
+		}
+		TrimDetailLevels();
 	}
 
 	template<typename TRuntime>